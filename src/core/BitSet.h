@@ -1,6 +1,7 @@
 #ifndef __BITSET_H__
 #define __BITSET_H__
 
+#include "Globals.h"
 #include <cassert>
 #include <cstdint>
 #include <string>
@@ -9,23 +10,35 @@ typedef uint64_t Word;
 
 const Word One = 1;
 
+// The number of words needed to hold a set over the largest supported (padded) board.
+const int MaxWords = (MaxPaddedArea + 63) / 64;
+
 // Bit set class which is used for quick board-wise operations.
+// The words are stored inline so that creating, copying and destroying a BitSet never touches
+// the heap.
+// The template parameter is the size of the board which the set is used with. For the
+// specialised board sizes the number of words is known at compile time, so the loops over the
+// words can be unrolled. A size of zero means any board size: the number of words is then
+// decided at runtime and there is room for the largest board.
+template<int N>
 class BitSet
 {
 public:
-    BitSet() = delete;
+    // The number of words which are stored.
+    static constexpr int Capacity = N > 0 ? ((N+2)*(N+2) + 63) / 64 : MaxWords;
+
+    // A set with no bits. Only useful as a placeholder to be assigned to later, so the words are
+    // left uninitialised (which keeps arrays of chains cheap to construct).
+    BitSet() : _numWords(0), _numBits(0) {}
     BitSet(int);
-    BitSet(const BitSet&);
-    ~BitSet();
 
-    inline int NumWords() const { return _numWords; }
+    inline int NumWords() const { return N > 0 ? Capacity : _numWords; }
 
     inline int NumBits() const { return _numBits; }
 
-    inline Word GetWord(size_t i) const
+    inline Word GetWord(int i) const
     {
-        assert(i < _numWords);
-        assert(_words != nullptr);
+        assert(i < NumWords());
         return _words[i];
     }
 
@@ -34,18 +47,30 @@ public:
     void Copy(const BitSet&);
 
     // Set the specified bit.
-    void Set(size_t);
+    inline void Set(size_t b)
+    {
+        assert(b < _numBits);
+        _words[b / WordSize] |= One << (b % WordSize);
+    }
 
     void Set(const BitSet&);
 
     // Unset the specified bit.
-    void UnSet(size_t);
+    inline void UnSet(size_t b)
+    {
+        assert(b < _numBits);
+        _words[b / WordSize] &= ~(One << (b % WordSize));
+    }
 
     // Unset the specified bits.
     void UnSet(const BitSet&);
 
     // Check the state of the specified bit.
-    bool Test(size_t) const;
+    inline bool Test(size_t b) const
+    {
+        assert(b < _numBits);
+        return _words[b / WordSize] & (One << b % WordSize);
+    }
 
     // Count the number of set bits.
     size_t Count() const;
@@ -61,6 +86,16 @@ public:
     // Invert this BitSet in place.
     void Invert();
 
+    // Move every bit the specified number of places towards the end of the set (or towards the
+    // start if negative). Bits which are moved off either end are lost.
+    void Shift(int);
+
+    // Treat this BitSet as a padded board with the specified row size and grow it by one point
+    // in each orthogonal direction, keeping only the allowed points.
+    // The allowed points must exclude the border so that nothing wraps around between rows.
+    // Returns whether any bits were added.
+    bool Dilate(int, const BitSet&);
+
     // Get the index of the n-th set bit in the word.
     int BitInWord(int, int) const;
 
@@ -72,12 +107,13 @@ public:
     std::string ToString() const;
 
 private:
-    const int WordSize = 64;
+    static const int WordSize = 64;
 
     // This is the internal representation of the bits.
-    Word* _words = nullptr;
+    // Words at or beyond _numWords are always zero.
+    Word _words[Capacity];
 
-    size_t _numWords;
+    int _numWords;
     size_t _numBits;
 
     // Get a string representation for the word.
@@ -89,12 +125,13 @@ private:
 };
 
 // This object allows iteration over the positions of the set bits in a BitSet.
+template<int N>
 class BitIterator
 {
 public:
     static const int NoBit = -2;
 
-    BitIterator(const BitSet& bs) : _bs(bs), _wi(0), _i(-1)
+    BitIterator(const BitSet<N>& bs) : _bs(bs), _wi(0), _i(-1)
     {
         _cw = _bs.GetWord(0);
     }
@@ -102,28 +139,27 @@ public:
     int Next();
 
 private:
-    const BitSet& _bs;
+    const BitSet<N>& _bs;
     int _wi;
     int _i;
     Word _cw;
 };
 
 // This object allows bits to be selected by index efficiently.
+template<int N>
 class BitSelector
 {
 public:
-    BitSelector(const BitSet& bs) : _bs(bs)
+    BitSelector(const BitSet<N>& bs) : _bs(bs)
     {
         InitialiseCounts();
     }
 
-    ~BitSelector();
-
     int operator[](int) const;
 
 private:
-    const BitSet& _bs;
-    int* _counts = nullptr;
+    const BitSet<N>& _bs;
+    int _counts[BitSet<N>::Capacity];
 
     void InitialiseCounts();
 };
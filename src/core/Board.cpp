@@ -1,13 +1,14 @@
 #include "Board.h"
-#include "patterns/PatternMatcher.h"
 #include <iostream>
 
-Board::Board(int boardSize)
+template<int N>
+Board<N>::Board(int boardSize)
 {
     InitialiseEmpty(boardSize);
 }
 
-Board::Board(Colour colourToMove, const std::vector<std::string>& s)
+template<int N>
+Board<N>::Board(Colour colourToMove, const std::vector<std::string>& s)
 {
     InitialiseEmpty(s.size());
 
@@ -31,152 +32,86 @@ Board::Board(Colour colourToMove, const std::vector<std::string>& s)
     _colourToMove = colourToMove;
 }
 
-Board::Board(Colour colourToMove, int boardSize, const MoveHistory& history)
+template<int N>
+Board<N>::Board(Colour colourToMove, int boardSize, const MoveHistory& history)
 {
     assert(boardSize > 0 && boardSize < MaxBoardSize);
 
-    InitialiseEmpty(boardSize);
-
+    // Only replay as much of the history as the board has room for.
     auto moves = history.Moves();
-    for (Move move : moves)
-        MakeMove(move);
-
-    _colourToMove = colourToMove;
-}
+    int length = std::min((int)moves.size(), MaxGameLength);
+    InitialiseEmpty(boardSize, length);
 
-Board::~Board()
-{
-    if (_points != nullptr)
-    {
-        for (int i = 0; i < _boardArea; i++)
-        {
-            Point pt = _points[i];
-            delete pt.Orthogonals;
-            delete pt.Diagonals;
-        }
-
-        delete[] _points;
-        _points = nullptr;
-    }
-
-    if (_blackStones != nullptr)
-    {
-        delete _blackStones;
-        _blackStones = nullptr;
-    }
-
-    if (_whiteStones != nullptr)
-    {
-        delete _whiteStones;
-        _whiteStones = nullptr;
-    }
+    for (int i = 0; i < length; i++)
+        MakeMove(moves[i]);
 
-    if (_empty != nullptr)
-    {
-        delete _empty;
-        _empty = nullptr;
-    }
-
-    for (StoneChain& sc : _chains)
-    {
-        if (sc.Stones != nullptr)
-        {
-            delete sc.Stones;
-            sc.Stones = nullptr;
-        }
-
-        if (sc.Neighbours != nullptr)
-        {
-            delete sc.Neighbours;
-            sc.Neighbours = nullptr;
-        }
-    }
+    _colourToMove = colourToMove;
 }
 
 // Clone fields from other.
-void Board::CloneFrom(const Board& other)
+template<int N>
+void Board<N>::CloneFrom(const Board& other)
 {
     assert(_boardSize == other._boardSize);
 
-    // Delete the existing chains 
-    for (size_t i = 0; i < _chains.size(); i++)
-    {
-        const StoneChain& c = _chains[i];
-        delete c.Stones;
-        delete c.Neighbours;
-    }
-
-    _chains.clear();
-
     _colourToMove = other._colourToMove;
     _turnNumber = other._turnNumber;
-    _lastMove = other._lastMove;
-    _hashes = other._hashes;
+    _turnLimit = other._turnLimit;
+    _lastPoint = other._lastPoint;
+    _koPoint = other._koPoint;
     memcpy(_passes, other._passes, 2*sizeof(bool));
+    _playoutMode = other._playoutMode;
 
     // Copy the stones for each player.
-    _empty->Copy(*other._empty);
-    _blackStones->Copy(*other._blackStones);
-    _whiteStones->Copy(*other._whiteStones);
-
-    // Copy the stone chains.
-    for (size_t i = 0; i < other._chains.size(); i++)
+    _empty = other._empty;
+    _blackStones = other._blackStones;
+    _whiteStones = other._whiteStones;
+
+    // Copy the points, hash history and stone chains which are in use.
+    memcpy(_colours, other._colours, PaddedArea()*sizeof(Colour));
+    memcpy(_chainIds, other._chainIds, PaddedArea()*sizeof(int16_t));
+#if LINKED_CHAINS
+    memcpy(_nextStone, other._nextStone, PaddedArea()*sizeof(int16_t));
+#endif
+    _numEmpty = other._numEmpty;
+    memcpy(_numStones, other._numStones, 2*sizeof(int));
+    memcpy(_emptyPoints, other._emptyPoints, _numEmpty*sizeof(int16_t));
+    memcpy(_emptyIndex, other._emptyIndex, PaddedArea()*sizeof(int16_t));
+    memcpy(_hashes, other._hashes, _turnNumber*sizeof(uint64_t));
+    _positions.CopyFrom(other._positions);
+
+    _numChains = other._numChains;
+    memcpy(_chains, other._chains, _numChains*sizeof(StoneChain<N>));
+
+    for (int i = 0; i < 2; i++)
     {
-        const StoneChain& oc = other._chains[i];
-        BitSet* stones = new BitSet(*oc.Stones);
-        BitSet* neighbours = new BitSet(*oc.Neighbours);
-
-        StoneChain c = { oc.Col, oc.Liberties, stones, neighbours, oc.Hash, oc.Ignore };
-        _chains.push_back(c);
-    }
-
-    // Map the points to their stone chains.
-    for (int i = 0; i < _boardArea; i++)
-    {
-        const Point& op = other._points[i];
-        _points[i].Col = op.Col;
-        _points[i].ChainId = op.ChainId;
-    }
-}
-
-// Check for potential eyes.
-// All orthogonals must be the same colour and there is also a constraint on diagonals.
-bool Board::IsEye(Colour col, int loc, int orth) const
-{
-    const Point& pt = _points[loc];
-    bool isEye = pt.Col == None;
-
-    if (isEye)
-    {
-        const BitSet* const enemy = col == Black ? _whiteStones : _blackStones;
-        int enemyDiag = pt.Diagonals->CountAndSparse(*enemy);
-
-        size_t n = pt.Neighbours.size();
-        isEye = n == 2 ? orth == 2 && enemyDiag == 0:
-                n == 3 ? orth == 3 && enemyDiag == 0:
-                n == 4 ? orth == 4 && enemyDiag <= 1:
-                false;
+        _chainsInAtari[i] = other._chainsInAtari[i];
+        _chainsWithTwoLiberties[i] = other._chainsWithTwoLiberties[i];
+        _eyes[i] = other._eyes[i];
     }
-
-    return isEye;
 }
 
 // Check the legality of the specified move in this position.
-MoveInfo Board::CheckMove(int loc) const
+template<int N>
+MoveInfo Board<N>::CheckMove(int loc) const
 {
     return CheckMove(_colourToMove, loc);
 }
 
 // Check the legality of the specified move in this position.
-MoveInfo Board::CheckMove(Colour col, int loc) const
+template<int N>
+MoveInfo Board<N>::CheckMove(Colour col, int loc) const
 {
     // Passing is always legal.
-    if (loc == PassCoord)
-        return Legal;
+    return loc == PassCoord ? Legal : CheckPoint(col, ToPoint(loc));
+}
 
+// Check the legality of a move at the specified point.
+template<int N>
+MoveInfo Board<N>::CheckPoint(Colour col, int point) const
+{
     // Check occupancy.
-    const Point& pt = _points[loc];
-    MoveInfo res = pt.Col == None ? Legal : Occupied;
+    MoveInfo res = _colours[point] == None ? Legal : Occupied;
     if (res == Legal)
     {
         // Check for suicide and ko.
@@ -184,7 +119,6 @@ MoveInfo Board::CheckMove(Colour col, int loc) const
         int captureLoc;
         size_t capturesWithRepetition = 0; // Note: captured neighbours could be in the same group!
         size_t friendlyOrthogonals = 0;
-        size_t safeFriendlyOrthogonals = 0;
 
         // Keep track of two chain ids.
         int chainId1 = -1;
@@ -193,45 +127,50 @@ MoveInfo Board::CheckMove(Colour col, int loc) const
         bool friendInAtari = false;
         bool isAtari = false;
         bool isLocal = false;
-        for (const Point* const n : pt.Neighbours)
+        for (int offset : Orthogonals())
         {
-            if (n->Col == None)
+            int nc = point + offset;
+            Colour ncol = _colours[nc];
+            if (ncol == None)
             {
                 ++liberties;
                 continue;
             }
+            else if (ncol == Border)
+            {
+                continue;
+            }
 
-            const StoneChain& c = _chains[n->ChainId];
-            int nlibs = c.Liberties;
-            if (n->Col == col)
+            int id = _chainIds[nc];
+            int nlibs = _chains[id].Liberties;
+            if (ncol == col)
             {
                 liberties += nlibs-1;
                 ++friendlyOrthogonals;
-                safeFriendlyOrthogonals += nlibs > 1 ? 1 : 0;
                 friendInAtari = friendInAtari || nlibs == 1;
 
-                if (chainId1 == -1) chainId1 = n->ChainId;
-                else if (chainId2 == -1 && n->ChainId != chainId1) chainId2 = n->ChainId;
+                if (chainId1 == -1) chainId1 = id;
+                else if (chainId2 == -1 && id != chainId1) chainId2 = id;
             }
             else
             {
                 if (nlibs == 1)
                 {
                     ++liberties;
-                    captureLoc = n->Coord;
-                    capturesWithRepetition += CountChainSize(n->ChainId);
+                    captureLoc = nc;
+                    capturesWithRepetition += CountChainSize(id);
                 }
                 else if (nlibs == 2)
                 {
                     isAtari = true;
                 }
 
-                isLocal |= n->Coord == _lastMove.Coord;
+                isLocal |= nc == _lastPoint;
             }
         }
 
         bool suicide = liberties == 0;
-        bool repetition = capturesWithRepetition == 1 && IsKoRepetition(col, loc, captureLoc);
+        bool repetition = capturesWithRepetition == 1 && IsKoRepetition(col, point, captureLoc);
         res = suicide ? Suicide : repetition ? Repetition : Legal;
 
         if (res & Legal)
@@ -245,7 +184,7 @@ MoveInfo Board::CheckMove(Colour col, int loc) const
             if (liberties == 1 && !koCapture) res |= SelfAtari;
             if (capturesWithRepetition > 0) res |= Capture;
             if (friendInAtari && liberties > 1) res |= Save;
-            if (IsEye(col, loc, safeFriendlyOrthogonals)) res |= FillsEye;
+            if (!friendInAtari && _eyes[(int)col-1].Test(point)) res |= FillsEye;
             if (isLocal) res |= Local;
             if (chainId2 != -1) res |= Connection;
 
@@ -253,8 +192,10 @@ MoveInfo Board::CheckMove(Colour col, int loc) const
             if (friendlyOrthogonals == 0)
             {
                 // Check for friendly diagonals.
-                const BitSet* const friendly = col == Black ? _blackStones : _whiteStones;
-                int friendlyDiag = pt.Diagonals->CountAndSparse(*friendly);
+                int friendlyDiag = 0;
+                for (int offset : Diagonals())
+                    friendlyDiag += _colours[point+offset] == col;
+
                 if (friendlyDiag >= 3) res |= EyeShape;
             }
         }
@@ -263,14 +204,216 @@ MoveInfo Board::CheckMove(Colour col, int loc) const
     return res;
 }
 
+// Classify every empty point for the current colour at once.
+template<int N>
+MoveMasks<N> Board<N>::GetMoveMasks() const
+{
+    return GetMoveMasks(_colourToMove);
+}
+
+// Classify every empty point for the specified colour at once.
+// This follows the same rules as CheckPoint, but each condition is built for the whole board from
+// the chains with few liberties and shifted copies of the stone sets.
+template<int N>
+MoveMasks<N> Board<N>::GetMoveMasks(Colour col) const
+{
+    int friendly = (int)col-1, enemy = 1-friendly;
+
+    // Gather the liberties of the enemy chains which can be captured or put in atari.
+    // The friendly chains in atari have no liberty to spare, so all other friendly stones are safe.
+    BitSet<N> captures(PaddedArea()), ataris(PaddedArea()), atariStones(PaddedArea());
+    int id;
+    BitIterator captureIt(_chainsInAtari[enemy]);
+    while ((id = captureIt.Next()) != BitIterator<N>::NoBit)
+        AddChainLiberties(_chains[id], captures);
+
+    BitIterator atariIt(_chainsWithTwoLiberties[enemy]);
+    while ((id = atariIt.Next()) != BitIterator<N>::NoBit)
+        AddChainLiberties(_chains[id], ataris);
+
+    BitIterator friendIt(_chainsInAtari[friendly]);
+    while ((id = friendIt.Next()) != BitIterator<N>::NoBit)
+    {
+#if LINKED_CHAINS
+        ForEachStone(_chains[id], [&](int stone) { atariStones.Set(stone); });
+#else
+        atariStones |= _chains[id].Stones;
+#endif
+    }
+
+    BitSet<N> safeStones(col == Black ? _blackStones : _whiteStones);
+    safeStones.UnSet(atariStones);
+
+    captures &= _empty;
+    ataris &= _empty;
+
+    MoveMasks<N> masks;
+
+    // A move has a liberty if it is next to an empty point, captures a chain or joins a friendly
+    // chain which has a liberty to spare.
+    BitSet<N> hasLiberty(_empty);
+    hasLiberty |= safeStones;
+    hasLiberty = AnyOrthogonal(hasLiberty);
+    hasLiberty |= captures;
+    masks.Suicide = _empty;
+    masks.Suicide.UnSet(hasLiberty);
+
+    // Only a capture can repeat a position and there are few of them, so check each one in turn.
+    masks.Repetition = BitSet<N>(PaddedArea());
+    int point;
+    BitIterator it(captures);
+    while ((point = it.Next()) != BitIterator<N>::NoBit)
+    {
+        if (CheckPoint(col, point) & Repetition)
+            masks.Repetition.Set(point);
+    }
+
+    masks.Legal = _empty;
+    masks.Legal.UnSet(masks.Suicide);
+    masks.Legal.UnSet(masks.Repetition);
+
+    masks.Capture = captures;
+    masks.Capture &= masks.Legal;
+    masks.Atari = ataris;
+    masks.Atari &= masks.Legal;
+
+    // An eye-like point fills an eye unless one of the chains around it is in atari.
+    masks.FillsEye = _eyes[friendly];
+    masks.FillsEye.UnSet(AnyOrthogonal(atariStones));
+    masks.FillsEye &= masks.Legal;
+
+    return masks;
+}
+
+// Find all of the eye-like points for the specified colour.
+// An eye-like point is surrounded by friendly stones (or the edge of the board). An enemy stone
+// can occupy one of its diagonals in the centre but none at the edge.
+template<int N>
+BitSet<N> Board<N>::FindEyes(Colour col) const
+{
+    const BitSet<N>& friendlyStones = col == Black ? _blackStones : _whiteStones;
+    const BitSet<N>& enemyStones = col == Black ? _whiteStones : _blackStones;
+
+    BitSet<N> border(_empty);
+    border |= _blackStones;
+    border |= _whiteStones;
+    border.Invert();
+
+    BitSet<N> walls(border);
+    walls |= friendlyStones;
+    BitSet<N> eyes = AllOrthogonal(walls);
+    eyes &= _empty;
+
+    BitSet<N> anyDiagonal(PaddedArea()), twoDiagonals(PaddedArea());
+    for (int offset : Diagonals())
+    {
+        BitSet<N> shifted(enemyStones);
+        shifted.Shift(-offset);
+
+        BitSet<N> both(anyDiagonal);
+        both &= shifted;
+        twoDiagonals |= both;
+        anyDiagonal |= shifted;
+    }
+
+    anyDiagonal &= AnyOrthogonal(border);
+    eyes.UnSet(anyDiagonal);
+    eyes.UnSet(twoDiagonals);
+
+    return eyes;
+}
+
+// Reassess whether the points in the 3x3 neighbourhood of the specified point are eye-like.
+// A point's eye status only depends on its own colour and those of its neighbours, so this is
+// all that needs to be done when a point changes colour.
+template<int N>
+void Board<N>::UpdateEyes(int point)
+{
+    auto orthogonals = Orthogonals();
+    auto diagonals = Diagonals();
+    for (int row = point-Stride(); row <= point+Stride(); row += Stride())
+    {
+        for (int p = row-1; p <= row+1; p++)
+        {
+            if (_colours[p] == Border)
+                continue;
+
+            _eyes[0].UnSet(p);
+            _eyes[1].UnSet(p);
+            if (_colours[p] != None)
+                continue;
+
+            // All orthogonals must be the same colour and there is also a constraint on diagonals
+            // (see FindEyes). Most points fail on the orthogonals so check those first.
+            int orth[4] = {0};
+            for (int offset : orthogonals)
+                ++orth[_colours[p+offset]];
+
+            int n = 4-orth[Border];
+            Colour col = orth[Black] == n ? Black : orth[White] == n ? White : None;
+            if (n >= 2 && col != None)
+            {
+                Colour enemy = col == Black ? White : Black;
+                int enemyDiag = 0;
+                for (int offset : diagonals)
+                    enemyDiag += _colours[p+offset] == enemy;
+
+                if (enemyDiag <= (n == 4 ? 1 : 0)) _eyes[(int)col-1].Set(p);
+            }
+        }
+    }
+}
+
+// Get the points which have at least one orthogonal neighbour in the set.
+// The orthogonal offsets come in opposite pairs so the direction of each shift doesn't matter.
+template<int N>
+BitSet<N> Board<N>::AnyOrthogonal(const BitSet<N>& bs) const
+{
+    BitSet<N> res(PaddedArea());
+    for (int offset : Orthogonals())
+    {
+        BitSet<N> shifted(bs);
+        shifted.Shift(offset);
+        res |= shifted;
+    }
+
+    return res;
+}
+
+// Get the points which have all of their orthogonal neighbours in the set.
+template<int N>
+BitSet<N> Board<N>::AllOrthogonal(const BitSet<N>& bs) const
+{
+    auto orthogonals = Orthogonals();
+    BitSet<N> res(bs);
+    res.Shift(orthogonals[0]);
+    for (int i = 1; i < 4; i++)
+    {
+        BitSet<N> shifted(bs);
+        shifted.Shift(orthogonals[i]);
+        res &= shifted;
+    }
+
+    return res;
+}
+
 // Get all moves available for the current colour.
-std::vector<Move> Board::GetMoves(bool duringPlayout) const
+template<int N>
+std::vector<Move> Board<N>::GetMoves(bool duringPlayout) const
 {
-    std::vector<Move> moves;
-    moves.reserve(_empty->Count());
+    MoveBuffer moves;
+    GetMoves(moves, duringPlayout);
+    return std::vector<Move>(moves.begin(), moves.end());
+}
+
+// Get all moves available for the current colour, replacing the contents of the buffer.
+template<int N>
+void Board<N>::GetMoves(MoveBuffer& moves, bool duringPlayout) const
+{
+    moves.clear();
     if (!GameOver())
     {
-        for (int i = 0; i < _boardArea; i++)
+        for (int i = 0; i < BoardArea(); i++)
         {
             MoveInfo info = CheckMove(i);
             if ((info & Legal) && !(info & FillsEye))
@@ -286,35 +429,40 @@ std::vector<Move> Board::GetMoves(bool duringPlayout) const
             moves.push_back({_colourToMove, PassCoord, Legal});
         }
     }
-
-    return moves;
 }
 
 // Get n random (legal) moves.
-std::vector<Move> Board::GetRandomLegalMoves(size_t n, RandomGenerator& gen) const
+template<int N>
+std::vector<Move> Board<N>::GetRandomLegalMoves(size_t n, RandomGenerator& gen) const
 {
-    std::vector<Move> moves;
-    moves.reserve(n);
+    MoveBuffer moves;
+    GetRandomLegalMoves(n, gen, moves);
+    return std::vector<Move>(moves.begin(), moves.end());
+}
+
+// Get n random (legal) moves, replacing the contents of the buffer.
+template<int N>
+void Board<N>::GetRandomLegalMoves(size_t n, RandomGenerator& gen, MoveBuffer& moves) const
+{
+    moves.clear();
     if (!GameOver())
     {
         // Can easily generate candidate moves by looking at the empty locations.
-        int numEmpty = _empty->Count();
-        assert(numEmpty != 0);
+        assert(_numEmpty != 0);
 
         int maxAttempts = 5*n;
         int a = 0, loc;
-        BitSelector bsl(*_empty);
         while (a++ < maxAttempts && moves.size() < n)
         {
             // Check a random empty point for validity.
-            loc = bsl[gen.Next(numEmpty)];
+            loc = _emptyPoints[gen.Next(_numEmpty)];
 
-            MoveInfo info = CheckMove(loc);
+            MoveInfo info = CheckPoint(_colourToMove, loc);
             bool legal = info & Legal;
             bool fillsEye = info & FillsEye;
             if (legal && !fillsEye)
             {
-                moves.push_back({_colourToMove, loc, info});
+                moves.push_back({_colourToMove, ToCoord(loc), info});
             }
         }
     }
@@ -323,21 +471,35 @@ std::vector<Move> Board::GetRandomLegalMoves(size_t n, RandomGenerator& gen) con
     // game is played out fully.
     if (moves.empty())
     {
-        moves = GetMoves(true);
+        GetMoves(moves, true);
     }
-
-    return moves;
 }
 
 // Find a global move that is adjacent to an enemy group with the specified number of liberties.
-Move Board::GetRandomMoveAttackingLiberties(size_t liberties, RandomGenerator& gen) const
+template<int N>
+Move Board<N>::GetRandomMoveAttackingLiberties(size_t liberties,
+                                               RandomGenerator& gen,
+                                               MoveBuffer& attackingMoves) const
 {
-    std::vector<Move> attackingMoves;
-    for (const auto& chain : _chains)
+    attackingMoves.clear();
+    int enemy = _colourToMove == Black ? 1 : 0;
+    if (liberties == 1)
+    {
+        FindLegalLibertyMoves(_chainsInAtari[enemy], attackingMoves);
+    }
+    else if (liberties == 2)
+    {
+        FindLegalLibertyMoves(_chainsWithTwoLiberties[enemy], attackingMoves);
+    }
+    else
     {
-        if (!chain.Ignore && chain.Col != _colourToMove && chain.Liberties == liberties)
+        for (int i = 0; i < _numChains; i++)
         {
-            FindLegalLibertyMoves(chain, attackingMoves);
+            const StoneChain<N>& chain = _chains[i];
+            if (chain.Col != _colourToMove && chain.Liberties == liberties)
+            {
+                FindLegalLibertyMoves(chain, attackingMoves);
+            }
         }
     }
 
@@ -345,162 +507,343 @@ Move Board::GetRandomMoveAttackingLiberties(size_t liberties, RandomGenerator& g
 }
 
 // Find a global move that is adjacent to a friendly group with only one liberty.
-Move Board::GetRandomMoveSaving(RandomGenerator& gen) const
+template<int N>
+Move Board<N>::GetRandomMoveSaving(RandomGenerator& gen, MoveBuffer& savingMoves) const
 {
-    std::vector<Move> savingMoves;
-    for (const auto& chain : _chains)
-    {
-        if (!chain.Ignore && chain.Col == _colourToMove && chain.Liberties == 1)
-        {
-            FindLegalLibertyMoves(chain, savingMoves);
-        }
-    }
+    savingMoves.clear();
+    FindLegalLibertyMoves(_chainsInAtari[(int)_colourToMove-1], savingMoves);
 
     return savingMoves.empty() ? BadMove : savingMoves[gen.Next(savingMoves.size())];
 }
 
 // Find a move that is local to the previous move and is considered urgent.
 // Note: Adjacent includes moves that fill liberties on the last move's chain.
-Move Board::GetRandomMoveLocal(int c, MoveInfo urgent, RandomGenerator& gen) const
+template<int N>
+Move Board<N>::GetRandomMoveLocal(int c,
+                                  MoveInfo urgent,
+                                  RandomGenerator& gen,
+                                  MoveBuffer& localMoves) const
 {
     assert(c != PassCoord);
-    std::vector<Move> localMoves;
+    localMoves.clear();
 
     // Use the "old" method for now.
-    const Point& pt = _points[c];
-    int m;
-    BitIterator it(*pt.Orthogonals);
-    while ((m = it.Next()) != BitIterator::NoBit)
+    int point = ToPoint(c);
+    for (int offset : Orthogonals())
     {
         // Test this location.
-        MoveInfo info = CheckMove(m);
+        int m = point + offset;
+        if (_colours[m] == Border)
+            continue;
+
+        MoveInfo info = CheckPoint(_colourToMove, m);
         if ((info & Legal) && (info & urgent))
         {
-            localMoves.push_back({_colourToMove, m, info});
+            localMoves.push_back({_colourToMove, ToCoord(m), info});
         }
     }
 
     // "New" method which crashes sometimes...
-  //const StoneChain& chain = _chains[_points[lastCoord].ChainId];
+  //const StoneChain<N>& chain = _chains[_chainIds[point]];
   //FindLegalLibertyMoves(chain, localMoves, urgent);
 
     return localMoves.empty() ? BadMove : localMoves[gen.Next(localMoves.size())];
 }
 
 // Find the legal moves that are adjacent to the specified chain.
-void Board::FindLegalLibertyMoves(const StoneChain& chain, std::vector<Move>& moves, MoveInfo urgent) const
+template<int N>
+void Board<N>::FindLegalLibertyMoves(const StoneChain<N>& chain, MoveBuffer& moves, MoveInfo urgent) const
 {
-    BitSet libs(*chain.Neighbours);
-    libs &= *_empty;
+    BitSet<N> libs(PaddedArea());
+    AddChainLiberties(chain, libs);
+    libs &= _empty;
 
     int bit;
     BitIterator it(libs);
-    while ((bit = it.Next()) != BitIterator::NoBit)
+    while ((bit = it.Next()) != BitIterator<N>::NoBit)
     {
-        MoveInfo info = CheckMove(bit);
+        MoveInfo info = CheckPoint(_colourToMove, bit);
         if (info & Legal)
         {
             if (urgent == 0 || (info & urgent))
             {
-                moves.push_back({_colourToMove, bit, info});
+                moves.push_back({_colourToMove, ToCoord(bit), info});
             }
         }
     }
 }
 
+// Find the legal moves that are adjacent to each of the chains in the set of IDs.
+template<int N>
+void Board<N>::FindLegalLibertyMoves(const BitSet<N>& ids, MoveBuffer& moves) const
+{
+    int id;
+    BitIterator it(ids);
+    while ((id = it.Next()) != BitIterator<N>::NoBit)
+        FindLegalLibertyMoves(_chains[id], moves);
+}
+
 // Update the board state with the specified move.
-void Board::MakeMove(const Move& move)
+template<int N>
+void Board<N>::MakeMove(const Move& move)
 {
     assert(!GameOver());
-    assert(CheckMove(move.Col, move.Coord) & Legal);
+    assert(CheckMove(move.Col(), move.Coord) & Legal);
 
+    // Positions are not hashed in playout mode, so the hash history is left alone.
     auto z = Zobrist::Instance();
-    uint64_t nextHash = _hashes[_turnNumber-1];
+    uint64_t nextHash = _playoutMode ? 0 : _hashes[_turnNumber-1];
 
-    if (move.Coord != PassCoord)
+    int point = move.Coord == PassCoord ? PassCoord : ToPoint(move.Coord);
+    _koPoint = PassCoord;
+    if (point != PassCoord)
     {
-        Point& pt = _points[move.Coord];
-        pt.Col = move.Col;
+        RecordPoint(point);
+        _colours[point] = move.Col();
+        RemoveEmptyPoint(point);
+        ++_numStones[(int)move.Col()-1];
 
         // Iterate through the chains which are affected by this move.
-        std::vector<int> neighbourChains, enemyChains;
-        for (Point* const n : pt.Neighbours)
+        // Chains which are captured or merged are released once the move has been made.
+        // Note: A move has four neighbours so at most four chains can be affected.
+        int neighbourChains[4], enemyChains[4], deadChains[4];
+        int numNeighbours = 0, numEnemies = 0, numDead = 0;
+        int capturedStones = 0, capturePoint = PassCoord;
+        for (int offset : Orthogonals())
         {
-            int nc = n->ChainId;
+            int nc = _chainIds[point+offset];
             if (nc != NoChain)
             {
-                const StoneChain& c = _chains[nc];
-                if (n->Col != move.Col && c.Liberties == 1)
+                const StoneChain<N>& c = _chains[nc];
+                if (c.Col != move.Col() && c.Liberties == 1)
                 {
                     // Capture this enemy group.
+                    capturedStones += CountChainSize(nc);
+                    capturePoint = point+offset;
                     nextHash ^= CaptureChain(nc);
+                    deadChains[numDead++] = nc;
                 }
-                else if (n->Col == move.Col)
+                else if (c.Col == move.Col())
                 {
                     // Friendly chain - need to merge.
-                    if (std::find(neighbourChains.begin(), neighbourChains.end(), nc) == neighbourChains.end())
-                        neighbourChains.push_back(nc);
+                    int* end = neighbourChains + numNeighbours;
+                    if (std::find(neighbourChains, end, nc) == end)
+                        neighbourChains[numNeighbours++] = nc;
                 }
-                else if (n->Col != None)
+                else
                 {
                     // Enemy chain.
-                    if (std::find(enemyChains.begin(), enemyChains.end(), nc) == enemyChains.end())
-                        enemyChains.push_back(nc);
+                    int* end = enemyChains + numEnemies;
+                    if (std::find(enemyChains, end, nc) == end)
+                        enemyChains[numEnemies++] = nc;
                 }
             }
         }
 
-        uint64_t moveHash  = z->Key(move.Col, move.Coord);
+        uint64_t moveHash = _playoutMode ? 0 : z->Key(move.Col(), point);
         nextHash ^= moveHash;
 
         // Update the cached BitSets.
-        BitSet* friendly = move.Col == Black ? _blackStones : _whiteStones;
-        friendly->Set(move.Coord);
-        _empty->UnSet(move.Coord);
+        BitSet<N>& friendly = move.Col() == Black ? _blackStones : _whiteStones;
+        friendly.Set(point);
+        _empty.UnSet(point);
+
+        UpdateEyes(point);
 
         // If there are friendly neighbouring chains then combine them.
-        CombineChainsForMove(move, moveHash, neighbourChains, enemyChains);
+        CombineChainsForMove(
+            move.Col(), point, moveHash, neighbourChains, numNeighbours, enemyChains, numEnemies);
+
+        // All but the first friendly chain have been merged away.
+        for (int i = 1; i < numNeighbours; i++)
+            deadChains[numDead++] = neighbourChains[i];
+
+        ReleaseChains(deadChains, numDead);
+
+        // A lone stone which captured a single stone and is left in atari can be retaken, which
+        // would repeat the position.
+        bool loneStoneInAtari = numNeighbours == 0 && _chains[_chainIds[point]].Liberties == 1;
+        if (capturedStones == 1 && loneStoneInAtari)
+            _koPoint = capturePoint;
+
+#if DEBUG_CHECKS
+        CheckLiberties();
+        CheckEyes();
+        CheckEmptyPoints();
+#endif
     }
 
     // Update the colour to move.
-    if (move.Col == _colourToMove)
+    if (move.Col() == _colourToMove)
     {
         _colourToMove = _colourToMove == Black ? White : Black;
         nextHash ^= CurrentRules.Ko == Situational ? z->BlackTurn() : 0;
     }
 
-    _hashes.push_back(nextHash);
-    _passes[(int)move.Col-1] = move.Coord == PassCoord;
-    _lastMove = move;
+    bool addedPosition = false;
+    if (!_playoutMode)
+    {
+        _hashes[_turnNumber] = nextHash;
+        addedPosition = _positions.Insert(_turnNumber, _hashes);
+    }
+
+    if (_journal != nullptr) _journal->_moves.back().AddedPosition = addedPosition;
+    _passes[(int)move.Col()-1] = move.Coord == PassCoord;
+    _lastPoint = point;
     ++_turnNumber;
 }
 
-// Compute the score of the current position.
-// Area scoring is used and we assume that all empty points are fully surrounded by one
-// colour.
-// The score is determined from black's perspective (positive score indicates black win).
-int Board::Score() const
+// Update the board state with the specified move, recording how to undo it in the journal.
+template<int N>
+void Board<N>::MakeMove(const Move& move, UndoJournal<N>& journal)
 {
-    double score = -CurrentRules.Komi;
-    for (int i = 0; i < _boardArea; i++)
+    journal._moves.push_back({
+        _turnNumber, _colourToMove, { _passes[0], _passes[1] }, _lastPoint, _koPoint, _numChains,
+        false, journal._points.size(), journal._liberties.size(), journal._chains.size() });
+
+    _journal = &journal;
+    MakeMove(move);
+    _journal = nullptr;
+}
+
+// Undo the last move recorded in the journal.
+template<int N>
+void Board<N>::UnmakeMove(UndoJournal<N>& journal)
+{
+    assert(!journal.Empty());
+    const typename UndoJournal<N>::MoveRecord& m = journal._moves.back();
+    assert(m.TurnNumber == _turnNumber-1);
+
+    // Restore the chain slots and then the liberties of the chains which were not overwritten.
+    for (size_t i = journal._chains.size(); i-- > m.FirstChain;)
+    {
+        const typename UndoJournal<N>::ChainRecord& r = journal._chains[i];
+        _chains[r.Id] = r.Chain;
+    }
+
+    for (size_t i = journal._liberties.size(); i-- > m.FirstLiberties;)
     {
-        const Point& pt = _points[i];
-        if (pt.Col == None)
+        const typename UndoJournal<N>::LibertiesRecord& r = journal._liberties[i];
+        _chains[r.ChainId].Liberties = r.Liberties;
+    }
+
+    // Restore the points along with the cached BitSets.
+    for (size_t i = journal._points.size(); i-- > m.FirstPoint;)
+    {
+        const typename UndoJournal<N>::PointRecord& r = journal._points[i];
+
+        // The empty point list was changed as each point was recorded, so undoing the changes in
+        // reverse order restores the list exactly.
+        if (_colours[r.Point] == None && r.Col != None)
         {
-            // Look at a neighbour.
-            Point const* const n = pt.Neighbours[0];
-            score += n->Col == Black ? 1 : -1;
+            assert(_emptyPoints[_numEmpty-1] == r.Point);
+            --_numEmpty;
         }
-        else
+        else if (_colours[r.Point] != None && r.Col == None)
         {
-            score += pt.Col == Black ? 1 : -1;
+            // Put the point back where it was and the point which replaced it back at the end.
+            if (r.EmptyIndex < _numEmpty) AddEmptyPoint(_emptyPoints[r.EmptyIndex]);
+            else ++_numEmpty;
+
+            _emptyPoints[r.EmptyIndex] = r.Point;
+            _emptyIndex[r.Point] = r.EmptyIndex;
         }
+
+        if (_colours[r.Point] != None) --_numStones[(int)_colours[r.Point]-1];
+        if (r.Col != None) ++_numStones[(int)r.Col-1];
+
+        _colours[r.Point] = r.Col;
+        _chainIds[r.Point] = r.ChainId;
+#if LINKED_CHAINS
+        _nextStone[r.Point] = r.NextStone;
+#endif
+
+        _empty.UnSet(r.Point);
+        _blackStones.UnSet(r.Point);
+        _whiteStones.UnSet(r.Point);
+        BitSet<N>& bs = r.Col == Black ? _blackStones : r.Col == White ? _whiteStones : _empty;
+        bs.Set(r.Point);
     }
 
-    return score > 0 ? 1 : score < 0 ? -1 : 0;
+    // The eye-like points can only be reassessed once all of the points have been restored.
+    for (size_t i = m.FirstPoint; i < journal._points.size(); i++)
+        UpdateEyes(journal._points[i].Point);
+
+    // Bring the liberty lists up to date with the restored chains, including any slots which have
+    // become live or been released again.
+    int numChains = _numChains;
+    _numChains = m.NumChains;
+    for (int id = std::min(numChains, _numChains); id < std::max(numChains, _numChains); id++)
+        UpdateLibertyLists(id);
+
+    for (size_t i = m.FirstChain; i < journal._chains.size(); i++)
+        UpdateLibertyLists(journal._chains[i].Id);
+
+    for (size_t i = m.FirstLiberties; i < journal._liberties.size(); i++)
+        UpdateLibertyLists(journal._liberties[i].ChainId);
+
+    if (m.AddedPosition) _positions.Remove(m.TurnNumber, _hashes);
+
+    _turnNumber = m.TurnNumber;
+    _colourToMove = m.ColourToMove;
+    memcpy(_passes, m.Passes, 2*sizeof(bool));
+    _lastPoint = m.LastPoint;
+    _koPoint = m.KoPoint;
+
+    journal._chains.resize(m.FirstChain);
+    journal._liberties.resize(m.FirstLiberties);
+    journal._points.resize(m.FirstPoint);
+    journal._moves.pop_back();
+
+#if DEBUG_CHECKS
+    CheckLiberties();
+    CheckEyes();
+    CheckEmptyPoints();
+#endif
+}
+
+// Compute the result of the current position.
+// The empty points can change the margin by at most their number, so the stone counts often
+// decide the result without scoring the empty points at all (especially at the end of a playout).
+template<int N>
+int Board<N>::Score() const
+{
+    double stoneMargin = _numStones[0] - _numStones[1] - CurrentRules.Komi;
+    if (stoneMargin > _numEmpty) return 1;
+    if (stoneMargin < -_numEmpty) return -1;
+
+    double margin = ScoreMargin();
+    return margin > 0 ? 1 : margin < 0 ? -1 : 0;
+}
+
+// Compute the Tromp-Taylor score margin of the current position.
+// The empty points reached by both colours are in both reach sets, so they cancel out and the
+// margin is just the difference in the sizes of the reach sets.
+template<int N>
+double Board<N>::ScoreMargin() const
+{
+    int blackArea = Reach(_blackStones).Count();
+    int whiteArea = Reach(_whiteStones).Count();
+    return blackArea - whiteArea - CurrentRules.Komi;
 }
 
-std::string Board::ToString() const
+// Flood fill from the stones through the empty points.
+// Each iteration dilates the whole set by one point in every direction using word-parallel
+// shifts, and the fill stops once it reaches a fixed point.
+template<int N>
+BitSet<N> Board<N>::Reach(const BitSet<N>& stones) const
+{
+    BitSet<N> allowed(_empty);
+    allowed |= stones;
+
+    BitSet<N> reach(stones);
+    while (reach.Dilate(Stride(), allowed));
+
+    return reach;
+}
+
+template<int N>
+std::string Board<N>::ToString() const
 {
     std::string s;
     Colour col;
@@ -508,7 +851,7 @@ std::string Board::ToString() const
     {
         for (int c = 0; c < _boardSize; c++)
         {
-            col = _points[r*_boardSize+c].Col;
+            col = PointColour(r*_boardSize+c);
             s += col == None ? '.' : col == Black ? 'B' : 'W';
         }
 
@@ -518,216 +861,441 @@ std::string Board::ToString() const
     return s;
 }
 
-// Initialise an empty board of the specified size.
-void Board::InitialiseEmpty(int boardSize)
+// Initialise an empty board of the specified size, which will be set up from a real game with
+// the specified number of moves.
+template<int N>
+void Board<N>::InitialiseEmpty(int boardSize, int historyLength)
 {
     assert(boardSize > 0 && boardSize < MaxBoardSize);
+    assert(N == 0 || boardSize == N);
 
     _colourToMove = Black;
     _boardSize = boardSize;
-    _boardArea = _boardSize*_boardSize;
+    _geometry = &Geometries[boardSize];
 
-    _empty = new BitSet(_boardArea);
-    _empty->Invert();
+    _empty = BitSet<N>(PaddedArea());
+    _blackStones = BitSet<N>(PaddedArea());
+    _whiteStones = BitSet<N>(PaddedArea());
+    for (int i = 0; i < 2; i++)
+    {
+        _chainsInAtari[i] = BitSet<N>(PaddedArea());
+        _chainsWithTwoLiberties[i] = BitSet<N>(PaddedArea());
+        _eyes[i] = BitSet<N>(PaddedArea());
+    }
 
-    _blackStones = new BitSet(_boardArea);
-    _whiteStones = new BitSet(_boardArea);
-    _points = new Point[_boardArea];
-    for (int i = 0; i < _boardArea; i++)
-        _points[i] = { None, i, {}, nullptr, nullptr, NoChain };
+    for (int i = 0; i < PaddedArea(); i++)
+    {
+        _colours[i] = Border;
+        _chainIds[i] = NoChain;
+        _emptyIndex[i] = -1;
+#if LINKED_CHAINS
+        _nextStone[i] = i;
+#endif
+    }
 
-    InitialiseNeighbours();
-    _hashes.push_back(CurrentRules.Ko == Situational ? Zobrist::Instance()->BlackTurn() : 0);
+    _numEmpty = 0;
+    for (int i = 0; i < BoardArea(); i++)
+    {
+        int point = ToPoint(i);
+        _colours[point] = None;
+        _empty.Set(point);
+        AddEmptyPoint(point);
+    }
+    _hashes[0] = CurrentRules.Ko == Situational ? Zobrist::Instance()->BlackTurn() : 0;
+    _turnLimit = historyLength + MoveLimit();
+    _positions.Reset(_turnLimit);
+    _positions.Insert(0, _hashes);
 }
 
-// Initialise the neighbours for each point.
-void Board::InitialiseNeighbours()
+// Check whether the specified move and capture would result in a board repetition.
+template<int N>
+bool Board<N>::IsKoRepetition(Colour col, int point, int capturePoint) const
 {
-    int r, c;
-    for (int i = 0; i < _boardArea; i++)
-    {
-        r = i / _boardSize, c = i % _boardSize;
-        _points[i].Coord = i;
+    // In playout mode only simple ko is detected, which doesn't need the hash history.
+    if (_playoutMode)
+        return point == _koPoint;
 
-        _points[i].Neighbours.clear();
-        _points[i].Orthogonals = new BitSet(_boardArea);
-        _points[i].Diagonals = new BitSet(_boardArea);
+    Colour enemyCol = col == Black ? White : Black;
+    auto z = Zobrist::Instance();
+    uint64_t nextHash = _hashes[_turnNumber-1]
+        ^ z->Key(col, point)
+        ^ z->Key(enemyCol, capturePoint)
+        ^ (CurrentRules.Ko == Situational ? z->BlackTurn() : 0);
 
-        // Setup the orthogonals.
-        // Also fill in the neighbours vector at this point.
-        if (r > 0)
-        {
-            _points[i].Neighbours.push_back(&_points[i-_boardSize]);
-            _points[i].Orthogonals->Set(i-_boardSize);
-        }
+    // Has this hash occurred previously?
+    return _positions.Contains(nextHash, _hashes);
+}
 
-        if (r < _boardSize-1)
-        {
-            _points[i].Neighbours.push_back(&_points[i+_boardSize]);
-            _points[i].Orthogonals->Set(i+_boardSize);
-        }
+template<int N>
+int Board<N>::CountChainLiberties(int id) const
+{
+    const StoneChain<N>& chain = _chains[id];
+#if LINKED_CHAINS
+    BitSet<N> libs(PaddedArea());
+    AddChainLiberties(chain, libs);
+    return libs.Count();
+#else
+    return chain.Neighbours.CountAnd(_empty);
+#endif
+}
+
+template<int N>
+int Board<N>::CountChainSize(int id) const
+{
+    const StoneChain<N>& chain = _chains[id];
+#if LINKED_CHAINS
+    return chain.Size;
+#else
+    return chain.Stones.Count();
+#endif
+}
 
-        if (c > 0)
+// Add the liberties of the chain to the set.
+// The chain's neighbours are already known when it keeps them as a set, but otherwise the
+// liberties are found by walking its stones.
+template<int N>
+void Board<N>::AddChainLiberties(const StoneChain<N>& chain, BitSet<N>& libs) const
+{
+#if LINKED_CHAINS
+    ForEachStone(chain, [&](int stone)
+    {
+        for (int offset : Orthogonals())
         {
-            _points[i].Neighbours.push_back(&_points[i-1]);
-            _points[i].Orthogonals->Set(i-1);
+            if (_colours[stone+offset] == None)
+                libs.Set(stone+offset);
         }
+    });
+#else
+    libs |= chain.Neighbours;
+#endif
+}
 
-        if (c < _boardSize-1)
+template<int N>
+uint64_t Board<N>::CaptureChain(int id)
+{
+    StoneChain<N>& chain = _chains[id];
+    ForEachStone(chain, [&](int bit)
+    {
+        RecordPoint(bit);
+        --_numStones[(int)_colours[bit]-1];
+        _colours[bit] = None;
+        _chainIds[bit] = NoChain;
+
+        _blackStones.UnSet(bit);
+        _whiteStones.UnSet(bit);
+        _empty.Set(bit);
+        AddEmptyPoint(bit);
+        UpdateEyes(bit);
+
+        // The point is now a liberty of each distinct chain next to it.
+        // Stones in the captured chain are either still labelled with its ID or already cleared.
+        int adjacent[4];
+        int numAdjacent = 0;
+        for (int offset : Orthogonals())
         {
-            _points[i].Neighbours.push_back(&_points[i+1]);
-            _points[i].Orthogonals->Set(i+1);
+            int nc = _chainIds[bit+offset];
+            if (nc != NoChain && nc != id
+                && std::find(adjacent, adjacent + numAdjacent, nc) == adjacent + numAdjacent)
+            {
+                adjacent[numAdjacent++] = nc;
+                RecordLiberties(nc);
+                ++_chains[nc].Liberties;
+                UpdateLibertyLists(nc);
+            }
         }
+    });
 
-        // Setup the diagonals.
-        if (r > 0 && c > 0) _points[i].Diagonals->Set(i-1-_boardSize);
-        if (r > 0 && c < _boardSize-1) _points[i].Diagonals->Set(i+1-_boardSize);
-        if (r < _boardSize-1 && c > 0) _points[i].Diagonals->Set(i-1+_boardSize);
-        if (r < _boardSize-1 && c < _boardSize-1) _points[i].Diagonals->Set(i+1+_boardSize);
-    }
+    return chain.Hash;
 }
 
-// Check whether the specified move and capture would result in a board repetition.
-bool Board::IsKoRepetition(Colour col, int loc, int captureLoc) const
+template<int N>
+void Board<N>::ReleaseChains(int* ids, int numIds)
 {
-    Colour enemyCol = col == Black ? White : Black;
-    auto z = Zobrist::Instance();
-    uint64_t nextHash = _hashes[_turnNumber-1]
-        ^ z->Key(col, loc)
-        ^ z->Key(enemyCol, captureLoc)
-        ^ (CurrentRules.Ko == Situational ? z->BlackTurn() : 0);
+    // Release the highest IDs first so that the chain which is moved down is never one that is
+    // also being released.
+    for (int i = 1; i < numIds; i++)
+        for (int j = i; j > 0 && ids[j-1] < ids[j]; j--)
+            std::swap(ids[j-1], ids[j]);
 
-    // Has this hash occurred previously?
-    bool repeat = false;
-    for (int i = _turnNumber-1; i >= 0 && !repeat; i--)
-        repeat = _hashes[i] == nextHash;
+    for (int i = 0; i < numIds; i++)
+    {
+        int id = ids[i];
+        int last = --_numChains;
+        if (id != last)
+        {
+            // Move the last chain into the free slot and relabel its stones.
+            RecordChain(id);
+            _chains[id] = _chains[last];
 
-    return repeat;
-}
+            ForEachStone(_chains[id], [&](int bit)
+            {
+                RecordPoint(bit);
+                _chainIds[bit] = id;
+            });
+        }
 
-int Board::CountChainLiberties(int id) const
-{
-    const StoneChain& chain = _chains[id];
-    return chain.Neighbours->CountAnd(*_empty);
+        UpdateLibertyLists(id);
+        UpdateLibertyLists(last);
+    }
 }
 
-int Board::CountChainSize(int id) const
+template<int N>
+void Board<N>::CheckLiberties() const
 {
-    const StoneChain& chain = _chains[id];
-    return chain.Stones->Count();
-}
+    for (int i = 0; i < _numChains; i++)
+    {
+        const StoneChain<N>& c = _chains[i];
+        if (c.Liberties != (size_t)CountChainLiberties(i))
+        {
+            std::cout << "Liberty mismatch for chain " << i << std::endl;
+            std::cout << ToString() << std::endl;
+            assert(false);
+        }
+    }
 
-uint64_t Board::CaptureChain(int id)
-{
-    StoneChain& chain = _chains[id];
-    int bit;
-    BitIterator it(*chain.Stones);
-    while ((bit = it.Next()) != BitIterator::NoBit)
+    // The liberty lists should contain exactly the chains with one or two liberties.
+    for (int i = 0; i < BoardArea(); i++)
+    {
+        for (int c = 0; c < 2; c++)
+        {
+            bool live = i < _numChains && (int)_chains[i].Col-1 == c;
+            bool inAtari = live && _chains[i].Liberties == 1;
+            bool twoLiberties = live && _chains[i].Liberties == 2;
+            if (_chainsInAtari[c].Test(i) != inAtari
+             || _chainsWithTwoLiberties[c].Test(i) != twoLiberties)
+            {
+                std::cout << "Liberty list mismatch for chain " << i << std::endl;
+                std::cout << ToString() << std::endl;
+                assert(false);
+            }
+        }
+    }
+
+#if LINKED_CHAINS
+    // Each chain's list should hold exactly the stones which are labelled with its ID.
+    int numStones = 0;
+    for (int i = 0; i < _numChains; i++)
     {
-        Point& pt = _points[bit];
-        pt.Col = None;
-        pt.ChainId = NoChain;
+        int size = 0;
+        ForEachStone(_chains[i], [&](int stone)
+        {
+            ++size;
+            if (_chainIds[stone] != i)
+            {
+                std::cout << "Stone list mismatch for chain " << i << std::endl;
+                std::cout << ToString() << std::endl;
+                assert(false);
+            }
+        });
 
-        _blackStones->UnSet(bit);
-        _whiteStones->UnSet(bit);
-        _empty->Set(bit);
+        assert(size == _chains[i].Size);
+        numStones += size;
     }
 
-    chain.Ignore = true;
+    assert(numStones == BoardArea() - _numEmpty);
+#endif
+}
 
-    // TODO: Update liberties of neighbouring chains.
-    for (size_t i = 0; i < _chains.size(); i++)
+template<int N>
+void Board<N>::CheckEyes() const
+{
+    for (int c = 0; c < 2; c++)
     {
-        StoneChain& c = _chains[i];
-        if (!c.Ignore)
+        BitSet<N> eyes = FindEyes((Colour)(c+1));
+        for (int i = 0; i < PaddedArea(); i++)
         {
-            c.Liberties = c.Neighbours->CountAnd(*_empty);
+            if (_eyes[c].Test(i) != eyes.Test(i))
+            {
+                std::cout << "Eye mismatch for colour " << c+1 << " at " << i << std::endl;
+                std::cout << ToString() << std::endl;
+                assert(false);
+            }
         }
     }
+}
 
-    return chain.Hash;
+template<int N>
+void Board<N>::CheckEmptyPoints() const
+{
+    bool consistent = _numEmpty == (int)_empty.Count()
+        && _numStones[0] == (int)_blackStones.Count()
+        && _numStones[1] == (int)_whiteStones.Count();
+    for (int i = 0; i < _numEmpty; i++)
+    {
+        int point = _emptyPoints[i];
+        consistent = consistent && _empty.Test(point) && _emptyIndex[point] == i;
+    }
+
+    if (!consistent)
+    {
+        std::cout << "Empty point or stone count mismatch" << std::endl;
+        std::cout << ToString() << std::endl;
+        assert(false);
+    }
 }
 
-void Board::CreateNewChainForMove(const Move& move, uint64_t moveHash)
+template<int N>
+void Board<N>::CreateNewChainForMove(Colour col, int point, uint64_t moveHash)
 {
-    Point& pt = _points[move.Coord];
+    size_t liberties = 0;
+    for (int offset : Orthogonals())
+        liberties += _colours[point+offset] == None;
 
-    BitSet* neighbours = new BitSet(*pt.Orthogonals);
-    BitSet* stones = new BitSet(_boardArea);
-    stones->Set(move.Coord);
+    assert(_numChains < AreaCapacity);
+    RecordChain(_numChains);
 
-    StoneChain c = { move.Col, (size_t)neighbours->CountAnd(*_empty), stones, neighbours, moveHash, false };
-    _chains.push_back(c);
+#if LINKED_CHAINS
+    _chains[_numChains] = { col, liberties, point, 1, moveHash };
+    _nextStone[point] = point;
+#else
+    BitSet<N> stones(PaddedArea());
+    stones.Set(point);
 
-    pt.ChainId = _chains.size()-1;
+    BitSet<N> neighbours(PaddedArea());
+    for (int offset : Orthogonals())
+        neighbours.Set(point+offset);
+
+    _chains[_numChains] = { col, liberties, stones, neighbours, moveHash };
+#endif
+
+    _chainIds[point] = _numChains++;
+    UpdateLibertyLists(_chainIds[point]);
 }
 
-void Board::CombineChainsForMove(const Move& move, uint64_t moveHash, const std::vector<int>& neighbourChains, const std::vector<int>& enemyChains)
+template<int N>
+void Board<N>::CombineChainsForMove(Colour col,
+                                    int point,
+                                    uint64_t moveHash,
+                                    int* neighbourChains,
+                                    int numNeighbours,
+                                    const int* enemyChains,
+                                    int numEnemies)
 {
     // Reduce the liberties of the enemy chains.
-    for (int i : enemyChains)
+    for (int j = 0; j < numEnemies; j++)
     {
-        StoneChain& c = _chains[i];
+        int i = enemyChains[j];
+        RecordLiberties(i);
+        StoneChain<N>& c = _chains[i];
         --c.Liberties;
+        UpdateLibertyLists(i);
     }
 
-    if (neighbourChains.empty())
+    if (numNeighbours == 0)
     {
-        CreateNewChainForMove(move, moveHash);
+        CreateNewChainForMove(col, point, moveHash);
     }
     else
     {
-        Point& pt = _points[move.Coord];
+        // Combine everything onto the largest neighbour chain.
+        for (int i = 1; i < numNeighbours; i++)
+        {
+            if (CountChainSize(neighbourChains[i]) > CountChainSize(neighbourChains[0]))
+                std::swap(neighbourChains[0], neighbourChains[i]);
+        }
 
-        // Combine everything onto the first neighbour chain.
-        int nc = neighbourChains.front();
-        StoneChain& base = _chains[nc];
+        int nc = neighbourChains[0];
+        RecordChain(nc);
+        StoneChain<N>& base = _chains[nc];
 
+#if LINKED_CHAINS
+        // The liberties of the merged chain are those of the base chain (apart from the new
+        // stone's point) plus any new ones next to the other stones. The other stones are
+        // relabelled as they are visited, so each new liberty is only counted once.
+        size_t liberties = base.Liberties-1;
+        auto addStone = [&](int stone)
+        {
+            for (int offset : Orthogonals())
+            {
+                int n = stone+offset;
+                if (_colours[n] == None && !IsNextToChain(n, nc))
+                    ++liberties;
+            }
+
+            _chainIds[stone] = nc;
+        };
+
+        // Splice the new stone (which has already been recorded) and then the other chains into
+        // the base chain's cycle.
+        RecordPoint(base.Head);
+        addStone(point);
+        _nextStone[point] = _nextStone[base.Head];
+        _nextStone[base.Head] = point;
+        base.Hash ^= moveHash;
+        ++base.Size;
+
+        for (int i = 1; i < numNeighbours; i++)
+        {
+            const StoneChain<N>& n = _chains[neighbourChains[i]];
+            ForEachStone(n, [&](int stone)
+            {
+                RecordPoint(stone);
+                addStone(stone);
+            });
+
+            std::swap(_nextStone[n.Head], _nextStone[base.Head]);
+            base.Hash ^= n.Hash;
+            base.Size += n.Size;
+        }
+
+        base.Liberties = liberties;
+        UpdateLibertyLists(nc);
+#else
         // Add the newly placed stone.
-        base.Stones->Set(move.Coord);
-        base.Neighbours->Set(*pt.Orthogonals);
+        base.Stones.Set(point);
+        for (int offset : Orthogonals())
+            base.Neighbours.Set(point+offset);
+
         base.Hash ^= moveHash;
-        pt.ChainId = nc;
+        _chainIds[point] = nc;
 
         // Add any other neighbouring chains.
-        for (size_t i = 1; i < neighbourChains.size(); i++)
+        for (int i = 1; i < numNeighbours; i++)
         {
-            StoneChain& n = _chains[neighbourChains[i]];
+            StoneChain<N>& n = _chains[neighbourChains[i]];
 
             // Update stones & neighbours.
-            base.Stones->Set(*n.Stones);
-            base.Neighbours->Set(*n.Neighbours);
+            base.Stones.Set(n.Stones);
+            base.Neighbours.Set(n.Neighbours);
             base.Hash ^= n.Hash;
 
             // Change the labels on the stones in the neighbour chain.
             int bit;
-            BitIterator it(*n.Stones);
-            while ((bit = it.Next()) != BitIterator::NoBit)
+            BitIterator it(n.Stones);
+            while ((bit = it.Next()) != BitIterator<N>::NoBit)
             {
-                Point& pt = _points[bit];
-                pt.ChainId = nc;
+                RecordPoint(bit);
+                _chainIds[bit] = nc;
             }
 
-            n.Ignore = true;
         }
 
         // Remove potential overlap of neighbours and stones.
-        base.Neighbours->UnSet(*base.Stones);
+        base.Neighbours.UnSet(base.Stones);
 
         // Reassess the liberties.
-        base.Liberties = base.Neighbours->CountAnd(*_empty);
+        base.Liberties = base.Neighbours.CountAnd(_empty);
+        UpdateLibertyLists(nc);
+#endif
     }
 }
 
-void Board::LogPointDetails(int coord) const
+template<int N>
+void Board<N>::LogPointDetails(int coord) const
 {
-    const Point& pt = _points[coord];
-    std::cout << pt.Coord << " " << pt.Col << " " << pt.ChainId << std::endl;
-    if (pt.ChainId != NoChain)
+    int point = ToPoint(coord);
+    int id = _chainIds[point];
+    std::cout << coord << " " << (int)_colours[point] << " " << id << std::endl;
+    if (id != NoChain)
     {
-        const StoneChain& c = _chains[pt.ChainId];
+        const StoneChain<N>& c = _chains[id];
         std::cout << "Liberties: " << c.Liberties << std::endl;
         std::cout << "Hash: " << c.Hash << std::endl;
-        std::cout << "Ignore: " << c.Ignore << std::endl;
     }
 }
+
+// Instantiate the general board along with the specialised sizes (see DispatchBoardSize).
+template class Board<0>;
+template class Board<9>;
+template class Board<13>;
+template class Board<19>;
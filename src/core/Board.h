@@ -2,9 +2,12 @@
 #define __BOARD_H__
 
 #include "BitSet.h"
+#include "BoardGeometry.h"
 #include "Globals.h"
 #include "Move.h"
+#include "MoveBuffer.h"
 #include "MoveHistory.h"
+#include "PositionSet.h"
 #include "RandomGenerator.h"
 #include "Rules.h"
 #include "Types.h"
@@ -12,143 +15,535 @@
 #include <cassert>
 #include <cstring>
 #include <algorithm>
+#include <array>
 #include <list>
 #include <string>
+#include <type_traits>
 #include <vector>
 
-// A chain of stones.
+// A chain of stones on a board of size N.
+// With LINKED_CHAINS the stones are held in a circular list threaded through the board (see
+// Board::_nextStone) starting from the head stone, so chains can be merged and released without
+// touching whole sets. Otherwise each chain keeps sets of its stones and their neighbours.
+template<int N>
 struct StoneChain 
 {
     Colour Col;
     size_t Liberties;
-    BitSet* Stones;
-    BitSet* Neighbours;
+#if LINKED_CHAINS
+    int Head;
+    int Size;
+#else
+    BitSet<N> Stones;
+    BitSet<N> Neighbours;
+#endif
     uint64_t Hash;
-    bool Ignore;
 };
 
-// Represents a single point on the goban.
-struct Point
+// The moves for one colour classified in bulk, with each class as a set of points.
+// These agree with the MoveInfo flags from checking each point in turn, except that the capture,
+// atari and eye-filling sets only contain legal moves.
+template<int N>
+struct MoveMasks
 {
-    Colour Col;
-    int Coord;
-    std::vector<Point*> Neighbours;
-    BitSet* Orthogonals;
-    BitSet* Diagonals;
-    int ChainId;
+    BitSet<N> Legal;
+    BitSet<N> Suicide;
+    BitSet<N> Repetition;
+    BitSet<N> Capture;
+    BitSet<N> Atari;
+    BitSet<N> FillsEye;
+};
+
+template<int N>
+class Board;
+
+// A record of the changes made to a board by a sequence of moves, which allows the moves to be
+// undone in reverse order.
+// Only the state which a move actually changes is recorded: the previous contents of each point
+// and chain slot which is overwritten and the previous liberty counts of any other chains.
+// The buffers keep their capacity when moves are undone so a journal can be reused without
+// allocating.
+template<int N = 0>
+class UndoJournal
+{
+public:
+    // The number of moves which can be undone.
+    inline size_t NumMoves() const { return _moves.size(); }
+
+    inline bool Empty() const { return _moves.empty(); }
+
+    void Clear()
+    {
+        _moves.clear();
+        _points.clear();
+        _liberties.clear();
+        _chains.clear();
+    }
+
+private:
+    friend class Board<N>;
+
+    // The state from before a move, along with where its records start in the other buffers.
+    struct MoveRecord
+    {
+        int TurnNumber;
+        Colour ColourToMove;
+        bool Passes[2];
+        int LastPoint;
+        int KoPoint;
+        int NumChains;
+        bool AddedPosition;
+        size_t FirstPoint;
+        size_t FirstLiberties;
+        size_t FirstChain;
+    };
+
+    struct PointRecord
+    {
+        int16_t Point;
+        Colour Col;
+        int16_t ChainId;
+        int16_t EmptyIndex;
+#if LINKED_CHAINS
+        int16_t NextStone;
+#endif
+    };
+
+    struct LibertiesRecord
+    {
+        int16_t ChainId;
+        int16_t Liberties;
+    };
+
+    struct ChainRecord
+    {
+        int Id;
+        StoneChain<N> Chain;
+    };
+
+    std::vector<MoveRecord> _moves;
+    std::vector<PointRecord> _points;
+    std::vector<LibertiesRecord> _liberties;
+    std::vector<ChainRecord> _chains;
 };
 
 // The board object which can be incrementally updated.
+// The template parameter is the board size. The commonly played sizes have their own
+// instantiations in which the geometry is known at compile time, while a size of zero gives a
+// board which can be any size (see DispatchBoardSize).
+template<int N = 0>
 class Board
 {
+static_assert(N >= 0 && N < MaxBoardSize, "Not a valid board size.");
+
+// The board state is held in fixed-capacity arrays so that cloning is just a matter of copying
+// memory.
+static_assert(std::is_trivially_copyable<StoneChain<N>>::value, "StoneChain must be trivially copyable.");
+
 public:
     Board() = delete;
     Board(int);
     Board(Colour, const std::vector<std::string>&);
     Board(Colour, int, const MoveHistory&);
 
-    ~Board();
-
-    inline int Size() const { return _boardSize; }
+    inline int Size() const { return N > 0 ? N : _boardSize; }
 
     inline Colour ColourToMove() const { return _colourToMove; }
 
     // Get the colour at the specified location.
     inline Colour PointColour(int loc) const
     {
-        return _points[loc].Col;
+        return _colours[ToPoint(loc)];
     }
 
     // Get the latest hash.
-    inline uint64_t CurrentHash() const { return _hashes[_turnNumber-1]; }
+    // Positions are not hashed in playout mode.
+    inline uint64_t CurrentHash() const
+    {
+        assert(!_playoutMode);
+        return _hashes[_turnNumber-1];
+    }
+
+    // Check whether the game has finished (both players passed or the move limit was reached).
+    inline bool GameOver() const
+    {
+        return (_passes[0] && _passes[1]) || _turnNumber >= _turnLimit;
+    }
 
-    // Check whether the game has finished (both players passed).
-    inline bool GameOver() const { return _passes[0] && _passes[1]; }
+    // The number of empty points.
+    inline int NumEmpty() const { return _numEmpty; }
+
+    // Get the coordinate of an empty point chosen uniformly at random.
+    inline int GetRandomEmptyCoord(RandomGenerator& gen) const
+    {
+        assert(_numEmpty > 0);
+        return ToCoord(_emptyPoints[gen.Next(_numEmpty)]);
+    }
+
+    // Check whether the board is in playout mode.
+    inline bool InPlayoutMode() const { return _playoutMode; }
+
+    // Switch to playout mode, which lasts until the board is next cloned.
+    // In this mode positions are not hashed at all. Only simple ko is detected (by remembering
+    // the point which can't be retaken) so full superko is only enforced for moves made before the
+    // playout started.
+    inline void EnterPlayoutMode() { _playoutMode = true; }
 
     // Clone fields from other.
+    // This copies only the parts of the state which are in use and never allocates.
     void CloneFrom(const Board&);
 
-    // Roughly check whether this point can possibly be an eye.
-    bool IsEye(Colour, int, int) const;
-
     // Get the properties of the specified move in this position.
     MoveInfo CheckMove(int) const;
 
     // Get the properties of the specified move in this position.
     MoveInfo CheckMove(Colour, int) const;
 
+    // Classify every empty point for the current colour at once.
+    MoveMasks<N> GetMoveMasks() const;
+
+    // Classify every empty point for the specified colour at once.
+    MoveMasks<N> GetMoveMasks(Colour) const;
+
+    // Convert between coordinates (as used in moves) and points (as used in the move masks).
+    inline int ToPoint(int coord) const { return Geometry().ToPoint[coord]; }
+
+    inline int ToCoord(int point) const { return Geometry().ToCoord[point]; }
+
     // Get all moves available for the current colour.
     std::vector<Move> GetMoves(bool duringPlayout = false) const;
 
+    // Get all moves available for the current colour, replacing the contents of the buffer.
+    void GetMoves(MoveBuffer&, bool duringPlayout = false) const;
+
     // Get n randomly chosen legal moves.
     std::vector<Move> GetRandomLegalMoves(size_t, RandomGenerator&) const;
 
+    // Get n randomly chosen legal moves, replacing the contents of the buffer.
+    void GetRandomLegalMoves(size_t, RandomGenerator&, MoveBuffer&) const;
+
+    // The following playout heuristics gather their candidate moves in the buffer, which is
+    // just scratch space. Playouts reuse one buffer so that they don't allocate.
+
     // Get a random move which is adjacent to an enemy group with n liberties.
-    Move GetRandomMoveAttackingLiberties(size_t, RandomGenerator&) const;
+    Move GetRandomMoveAttackingLiberties(size_t, RandomGenerator&, MoveBuffer&) const;
 
     // Get a random move which (potentially) saves a group from capture.
-    Move GetRandomMoveSaving(RandomGenerator&) const;
+    Move GetRandomMoveSaving(RandomGenerator&, MoveBuffer&) const;
 
     // Get a random move which is local move and is perceived as urgent.
-    Move GetRandomMoveLocal(int, MoveInfo, RandomGenerator&) const;
+    Move GetRandomMoveLocal(int, MoveInfo, RandomGenerator&, MoveBuffer&) const;
 
     // Update the board state with the specified move.
     void MakeMove(const Move&);
 
-    // Compute the score of the current position.
-    // Area scoring is used and we assume that all empty points are fully surrounded by one
-    // colour.
-    // The score is determined from black's perspective (positive score indicates black win).
+    // Update the board state with the specified move, recording how to undo it in the journal.
+    void MakeMove(const Move&, UndoJournal<N>&);
+
+    // Undo the last move recorded in the journal, restoring the previous state exactly.
+    // The journal must have been filled in by this board and nothing else can have changed the
+    // board since.
+    void UnmakeMove(UndoJournal<N>&);
+
+    // Compute the result of the current position: 1 for a black win, -1 for a white win and 0
+    // for a draw.
     int Score() const;
 
+    // Compute the score margin of the current position using Tromp-Taylor area scoring.
+    // A player's area is their stones plus the empty points which only reach their stones, so
+    // dame and shared liberties in seki count for neither player.
+    // The margin is determined from black's perspective and includes komi.
+    double ScoreMargin() const;
+
     std::string ToString() const;
 
 private:
     const int NoChain = -1;
 
+    // The inline arrays only need to be large enough for boards of this size.
+    static constexpr int SizeCapacity = N > 0 ? N : MaxBoardSize;
+    static constexpr int AreaCapacity = SizeCapacity*SizeCapacity;
+    static constexpr int PaddedCapacity = (SizeCapacity+2)*(SizeCapacity+2);
+    static constexpr int GameLengthCapacity = MaxGameLength + MaxMovesPerPoint*AreaCapacity;
+
+    // The board is stored row by row with a border of width one around it (see BoardGeometry).
+    // The geometry is derived from the size, so it is constant for the specialised sizes.
+    int _boardSize;
+
+    // The shared geometry tables for this board's size.
+    const BoardGeometry* _geometry;
+
+    inline const BoardGeometry& Geometry() const
+    {
+        return N > 0 ? Geometries[N] : *_geometry;
+    }
+
+    inline int BoardArea() const { return Size()*Size(); }
+
+    inline int Stride() const { return Size()+2; }
+
+    inline int PaddedArea() const { return Stride()*Stride(); }
+
+    // Games are limited to a fixed number of moves per point after the history which the board
+    // was set up from (see _turnLimit).
+    inline int MoveLimit() const { return MaxMovesPerPoint*BoardArea(); }
+
+    // The offsets to the orthogonal and diagonal neighbours of a point.
+    inline std::array<int, 4> Orthogonals() const { return { -Stride(), Stride(), -1, 1 }; }
+
+    inline std::array<int, 4> Diagonals() const
+    {
+        return { -Stride()-1, -Stride()+1, Stride()-1, Stride()+1 };
+    }
+
+    // The journal which the current move is being recorded in (if any).
+    UndoJournal<N>* _journal = nullptr;
+
+    // The mutable state follows. Everything from here on is trivially copyable.
     Colour _colourToMove = Black;
-    Point* _points = nullptr;
-    std::vector<uint64_t> _hashes;
     int _turnNumber = 1;
-    int _boardSize;
-    int _boardArea;
-    bool _passes[2] = {false};
 
-    BitSet* _empty = nullptr;
-    BitSet* _blackStones = nullptr;
-    BitSet* _whiteStones = nullptr;
-    std::vector<StoneChain> _chains;
-    Move _lastMove = { None, PassCoord, 0 };
+    // The turn at which the game is over. The real game's history doesn't count towards the move
+    // limit, so a long game can still be played out.
+    int _turnLimit = 1;
+    bool _passes[2] = {false};
+    bool _playoutMode = false;
+    int _lastPoint = PassCoord;
+
+    // The point where a stone was just captured in a simple ko, which the opponent can't retake
+    // straight away. This is only used in playout mode.
+    int _koPoint = PassCoord;
+
+    BitSet<N> _empty;
+    BitSet<N> _blackStones;
+    BitSet<N> _whiteStones;
+
+    // The colour and chain ID of each point. The border points are coloured Border and have no
+    // chain.
+    Colour _colours[PaddedCapacity];
+    int16_t _chainIds[PaddedCapacity];
+
+#if LINKED_CHAINS
+    // The next stone in the chain of each stone, which links the stones of each chain into a
+    // cycle. This is only meaningful for the points which have stones.
+    int16_t _nextStone[PaddedCapacity];
+#endif
+
+    // The empty points in no particular order, along with the index of each point in this list
+    // (only meaningful while the point is empty), so that points can be added and removed in
+    // constant time.
+    int _numEmpty = 0;
+    int16_t _emptyPoints[AreaCapacity];
+    int16_t _emptyIndex[PaddedCapacity];
+
+    // The number of stones of each colour, which often decides the result on its own (see Score).
+    int _numStones[2] = {0};
+
+    // The hash of the position after each move. Only the first _turnNumber are in use.
+    // There is room for the longest real game followed by a game's worth of moves.
+    uint64_t _hashes[GameLengthCapacity];
+
+    // The set of positions in the history, used to detect superko.
+    PositionSet<GameLengthCapacity> _positions;
+
+    // The stone chains which are on the board. Dead chains are released as soon as they are
+    // captured or merged so the first _numChains are always live.
+    int _numChains = 0;
+    StoneChain<N> _chains[AreaCapacity];
+
+    // The IDs of the chains of each colour which are in atari or have two liberties, so that the
+    // tactical moves can be found without scanning every chain.
+    BitSet<N> _chainsInAtari[2];
+    BitSet<N> _chainsWithTwoLiberties[2];
+
+    // The eye-like points for each colour, which are updated around each point that changes.
+    BitSet<N> _eyes[2];
 
     // Initialise an empty board of the specified size.
-    void InitialiseEmpty(int);
+    void InitialiseEmpty(int, int historyLength = 0);
+
+    // Get the properties of the specified move at a point.
+    MoveInfo CheckPoint(Colour, int) const;
+
+    // Get the points which have at least one orthogonal neighbour in the set.
+    BitSet<N> AnyOrthogonal(const BitSet<N>&) const;
+
+    // Get the points which have all of their orthogonal neighbours in the set.
+    BitSet<N> AllOrthogonal(const BitSet<N>&) const;
 
-    // Initialise the neighbours for each point.
-    void InitialiseNeighbours();
+    // Find all of the eye-like points for the specified colour.
+    BitSet<N> FindEyes(Colour) const;
+
+    // Reassess the eye-like points around a point which has changed colour.
+    void UpdateEyes(int);
+
+    // Flood fill from the specified stones through the empty points.
+    // Returns the stones together with all of the empty points that they reach.
+    BitSet<N> Reach(const BitSet<N>&) const;
 
     // Check whether the specified move and capture would result in a board repetition.
     bool IsKoRepetition(Colour, int, int) const;
 
-    void FindLegalLibertyMoves(const StoneChain&, std::vector<Move>&, MoveInfo urgent = 0) const;
+    void FindLegalLibertyMoves(const StoneChain<N>&, MoveBuffer&, MoveInfo urgent = 0) const;
+
+    // Find the legal moves adjacent to each of the chains in the set of IDs.
+    void FindLegalLibertyMoves(const BitSet<N>&, MoveBuffer&) const;
 
     // Count the liberties of the given chain.
     int CountChainLiberties(int) const;
 
     int CountChainSize(int) const;
 
+    // Add the liberties of the chain to the set. Other neighbours of the chain may also be added.
+    void AddChainLiberties(const StoneChain<N>&, BitSet<N>&) const;
+
+    // Call the function with each stone in the chain.
+    // The function may change the stone's point but not the chain itself.
+    template<class F>
+    inline void ForEachStone(const StoneChain<N>& chain, F f) const
+    {
+#if LINKED_CHAINS
+        int stone = chain.Head;
+        do
+        {
+            int next = _nextStone[stone];
+            f(stone);
+            stone = next;
+        }
+        while (stone != chain.Head);
+#else
+        int bit;
+        BitIterator it(chain.Stones);
+        while ((bit = it.Next()) != BitIterator<N>::NoBit)
+            f(bit);
+#endif
+    }
+
     // Capture the chain with the specified ID.
     // Returns the hash of the chain.
     uint64_t CaptureChain(int);
 
-    void CreateNewChainForMove(const Move&, uint64_t);
+    // Release the chains with the specified IDs, keeping the live chains contiguous.
+    void ReleaseChains(int*, int);
+
+    // Record the current contents of a point in the journal (if there is one).
+    inline void RecordPoint(int point)
+    {
+        if (_journal != nullptr)
+        {
+#if LINKED_CHAINS
+            _journal->_points.push_back({
+                (int16_t)point, _colours[point], _chainIds[point], _emptyIndex[point],
+                _nextStone[point] });
+#else
+            _journal->_points.push_back({
+                (int16_t)point, _colours[point], _chainIds[point], _emptyIndex[point] });
+#endif
+        }
+    }
+
+    // Add a point to the end of the empty point list.
+    inline void AddEmptyPoint(int point)
+    {
+        _emptyIndex[point] = _numEmpty;
+        _emptyPoints[_numEmpty++] = point;
+    }
+
+    // Remove a point from the empty point list by moving the last point into its place.
+    // Undoing this requires the point's previous index, which is recorded in the journal.
+    inline void RemoveEmptyPoint(int point)
+    {
+        int i = _emptyIndex[point];
+        int last = _emptyPoints[--_numEmpty];
+        _emptyPoints[i] = last;
+        _emptyIndex[last] = i;
+    }
+
+    // Record the current liberties of a chain in the journal (if there is one).
+    // The liberties of a chain are always updated before any chain slot is overwritten, so when
+    // a move is undone the chain slots can be restored first.
+    inline void RecordLiberties(int id)
+    {
+        if (_journal != nullptr)
+        {
+            assert(_journal->_chains.size() == _journal->_moves.back().FirstChain);
+            _journal->_liberties.push_back({ (int16_t)id, (int16_t)_chains[id].Liberties });
+        }
+    }
+
+    // Record the current contents of a chain slot in the journal (if there is one).
+    inline void RecordChain(int id)
+    {
+        if (_journal != nullptr)
+            _journal->_chains.push_back({ id, _chains[id] });
+    }
+
+    // Update the atari and two liberty lists for the chain slot with the specified ID.
+    // This must be called whenever a chain's liberties change or its slot is reused or released.
+    inline void UpdateLibertyLists(int id)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            _chainsInAtari[i].UnSet(id);
+            _chainsWithTwoLiberties[i].UnSet(id);
+        }
+
+        if (id < _numChains)
+        {
+            const StoneChain<N>& chain = _chains[id];
+            int c = (int)chain.Col-1;
+            if (chain.Liberties == 1) _chainsInAtari[c].Set(id);
+            else if (chain.Liberties == 2) _chainsWithTwoLiberties[c].Set(id);
+        }
+    }
 
-    // Merge the specified chains.
-    void CombineChainsForMove(const Move&,
-                              uint64_t,
-                              const std::vector<int>&,
-                              const std::vector<int>&);
+    // Check that the incrementally maintained liberties match a full recount.
+    void CheckLiberties() const;
+
+    // Check that the incrementally maintained eye-like points match a full search.
+    void CheckEyes() const;
+
+    // Check that the empty point list and stone counts match the points.
+    void CheckEmptyPoints() const;
+
+    void CreateNewChainForMove(Colour, int, uint64_t);
+
+    // Merge the specified friendly chains and take a liberty from the enemy chains.
+    // The chains are merged onto the first one, which may be swapped with a larger chain so that
+    // fewer stones need relabelling.
+    void CombineChainsForMove(Colour, int, uint64_t, int*, int, const int*, int);
+
+#if LINKED_CHAINS
+    // Check whether the point is next to a stone in the specified chain.
+    inline bool IsNextToChain(int point, int id) const
+    {
+        for (int offset : Orthogonals())
+        {
+            if (_chainIds[point+offset] == id)
+                return true;
+        }
+
+        return false;
+    }
+#endif
 
     void LogPointDetails(int) const;
 };
 
+// Call the functor's templated operator with the board size to use for the specified size.
+// The commonly played sizes have their own specialised boards and any other size uses the general
+// board, e.g. DispatchBoardSize(size, [&]<int N>() { Board<N> board(size); ... });
+// Note: The specialised sizes must match the instantiations in Board.cpp and BitSet.cpp.
+template<class F>
+auto DispatchBoardSize(int boardSize, F f)
+{
+    switch (boardSize)
+    {
+        case 9: return f.template operator()<9>();
+        case 13: return f.template operator()<13>();
+        case 19: return f.template operator()<19>();
+        default: return f.template operator()<0>();
+    }
+}
+
 #endif // __BOARD_H__
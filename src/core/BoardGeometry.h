@@ -0,0 +1,49 @@
+#ifndef __BOARD_GEOMETRY_H__
+#define __BOARD_GEOMETRY_H__
+
+#include "Globals.h"
+#include "Move.h"
+#include <array>
+#include <cstdint>
+
+// The layout of a board of one size.
+// The board is stored row by row with a border of width one around it. Points are indices into
+// these padded arrays, whereas coordinates (as used in moves) are indices into the unpadded board.
+struct BoardGeometry
+{
+    int Size = 0;
+    int Stride = 0;
+
+    // Lookup tables between coordinates and points. Border points have no coordinate.
+    alignas(64) int16_t ToPoint[MaxBoardArea] = {};
+    alignas(64) int16_t ToCoord[MaxPaddedArea] = {};
+
+    constexpr BoardGeometry() = default;
+
+    constexpr BoardGeometry(int size) : Size(size), Stride(size+2)
+    {
+        for (int i = 0; i < MaxPaddedArea; i++)
+            ToCoord[i] = PassCoord;
+
+        for (int i = 0; i < size*size; i++)
+        {
+            int point = (i / size + 1)*Stride + i % size + 1;
+            ToPoint[i] = point;
+            ToCoord[point] = i;
+        }
+    }
+};
+
+// The geometry of every supported board size.
+// This is built at compile time, so boards never have to compute it and all of the boards of a
+// size share the same read-only tables.
+inline constexpr std::array<BoardGeometry, MaxBoardSize> Geometries = []()
+{
+    std::array<BoardGeometry, MaxBoardSize> geometries;
+    for (int size = 1; size < MaxBoardSize; size++)
+        geometries[size] = BoardGeometry(size);
+
+    return geometries;
+}();
+
+#endif // __BOARD_GEOMETRY_H__
@@ -4,4 +4,16 @@
 const int MaxBoardSize = 25;
 const int MaxBoardArea = MaxBoardSize*MaxBoardSize;
 
+// Internally the board is surrounded by a border one point wide so that every point on the
+// board has four neighbours.
+const int MaxPaddedSize = MaxBoardSize+2;
+const int MaxPaddedArea = MaxPaddedSize*MaxPaddedSize;
+
+// Games (including playouts) are limited to this many moves per point on the board, not counting
+// the real game's history which the board was set up from. Beyond this the game is over.
+const int MaxMovesPerPoint = 3;
+
+// The longest real game history which a board can be set up from.
+const int MaxGameLength = MaxMovesPerPoint*MaxBoardArea;
+
 #endif // __GLOBALS_H__
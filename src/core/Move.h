@@ -1,6 +1,7 @@
 #ifndef __MOVE_H__
 #define __MOVE_H__
 
+#include "Globals.h"
 #include "Types.h"
 #include "Utils.h"
 #include <string>
@@ -10,15 +11,21 @@ const int PassCoord = -1;
 const int BadCoord = -2;
 
 // The data for a single move.
+// Moves are copied into every move list and tree node, so the fields are packed into one word.
+// Every field is an int because compilers only share a word between bit-fields of the same size
+// of type. The fields are signed so that PassCoord and BadCoord fit, and they are wide enough for
+// the largest board and all of the move info flags.
 struct Move
 {
-    Colour Col;
-    int Coord;
-    MoveInfo Info;
+    int ColBits : 3;
+    int Coord : 14;
+    MoveInfo Info : 15;
+
+    inline Colour Col() const { return (Colour)ColBits; }
 
     bool operator==(const Move& other) const
     {
-        return Col == other.Col && Coord == other.Coord;
+        return ColBits == other.ColBits && Coord == other.Coord;
     }
 
     bool operator!=(const Move& other) const
@@ -27,6 +34,10 @@ struct Move
     }
 };
 
+static_assert(sizeof(Move) == 4, "Move should be packed into one word.");
+static_assert(White < (1 << 2) && MaxBoardArea < (1 << 13) && EyeShape < (1 << 14),
+              "Move fields are too narrow.");
+
 // This represents an invalid move.
 const Move BadMove = { None, BadCoord, 0 };
 
@@ -56,8 +67,8 @@ inline std::string CoordToString(int coord, int n)
 // Get the string representation of the move.
 inline std::string MoveToString(const Move& move, int n)
 {
-    assert(move.Col != None);
-    std::string s = move.Col == Black ? "B " : "W "; 
+    assert(move.Col() != None);
+    std::string s = move.Col() == Black ? "B " : "W "; 
     s += CoordToString(move.Coord, n);
     return s;
 }
@@ -0,0 +1,44 @@
+#ifndef __MOVE_BUFFER_H__
+#define __MOVE_BUFFER_H__
+
+#include "Globals.h"
+#include "Move.h"
+#include <cassert>
+
+// A list of moves with room for every point on the largest board plus a pass.
+// The moves are stored inline so filling the list never allocates, which makes it suitable as a
+// scratch buffer which is reused for each move of a playout.
+// The interface follows std::vector so that it can be used in the same way.
+class MoveBuffer
+{
+public:
+    static constexpr int Capacity = MaxBoardArea+1;
+
+    inline size_t size() const { return _size; }
+
+    inline bool empty() const { return _size == 0; }
+
+    inline void clear() { _size = 0; }
+
+    inline void push_back(const Move& move)
+    {
+        assert(_size < Capacity);
+        _moves[_size++] = move;
+    }
+
+    inline const Move& operator[](size_t i) const
+    {
+        assert(i < _size);
+        return _moves[i];
+    }
+
+    inline const Move* begin() const { return _moves; }
+
+    inline const Move* end() const { return _moves + _size; }
+
+private:
+    size_t _size = 0;
+    Move _moves[Capacity];
+};
+
+#endif // __MOVE_BUFFER_H__
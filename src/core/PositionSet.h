@@ -0,0 +1,103 @@
+#ifndef __POSITION_SET_H__
+#define __POSITION_SET_H__
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+// An open-addressed (linear probing) hash set of the positions in a game's hash history, which
+// is used to detect superko in constant time.
+// Each slot holds the index of a position in the history rather than its hash, so the set is
+// small enough to be copied cheaply along with the board. The slots are stored inline and only
+// those needed for the board size are in use.
+// The template parameter is the largest number of positions that the set will be asked to hold.
+template<int MaxPositions>
+class PositionSet
+{
+public:
+    // Clear the set and size it to hold the specified number of positions.
+    void Reset(int maxPositions)
+    {
+        assert(maxPositions <= MaxPositions);
+
+        size_t capacity = SlotsFor(maxPositions);
+        assert(capacity <= MaxSlots);
+
+        _mask = capacity - 1;
+        memset(_slots, 0xFF, capacity*sizeof(uint16_t));
+    }
+
+    inline size_t Capacity() const { return _mask + 1; }
+
+    // Check whether the hash occurs in the history.
+    bool Contains(uint64_t hash, const uint64_t* history) const
+    {
+        size_t i = hash & _mask;
+        while (_slots[i] != Empty)
+        {
+            if (history[_slots[i]] == hash) return true;
+            i = (i + 1) & _mask;
+        }
+
+        return false;
+    }
+
+    // Add the position at the specified index in the history.
+    // Returns false if the position was already present.
+    bool Insert(int index, const uint64_t* history)
+    {
+        uint64_t hash = history[index];
+        size_t i = hash & _mask;
+        while (_slots[i] != Empty)
+        {
+            if (history[_slots[i]] == hash) return false;
+            i = (i + 1) & _mask;
+        }
+
+        _slots[i] = index;
+        return true;
+    }
+
+    // Remove the position at the specified index in the history.
+    // This must be the most recently inserted position, in which case just emptying its slot
+    // leaves every other probe sequence as it was.
+    void Remove(int index, const uint64_t* history)
+    {
+        size_t i = history[index] & _mask;
+        while (_slots[i] != index)
+        {
+            assert(_slots[i] != Empty);
+            i = (i + 1) & _mask;
+        }
+
+        _slots[i] = Empty;
+    }
+
+    // Copy the contents of another set, which may have been sized for a different number of
+    // positions.
+    void CopyFrom(const PositionSet& other)
+    {
+        _mask = other._mask;
+        memcpy(_slots, other._slots, Capacity()*sizeof(uint16_t));
+    }
+
+private:
+    // The number of slots needed to hold the specified number of positions.
+    // Keep the load factor below 2/3 so that probe sequences stay short.
+    static constexpr size_t SlotsFor(int positions)
+    {
+        size_t slots = 1;
+        while (slots < (size_t)(3*positions/2 + 1)) slots <<= 1;
+        return slots;
+    }
+
+    static constexpr size_t MaxSlots = SlotsFor(MaxPositions);
+
+    static const uint16_t Empty = 0xFFFF;
+    static_assert(MaxPositions < Empty, "History indices must fit in a slot.");
+
+    size_t _mask = 0;
+    uint16_t _slots[MaxSlots];
+};
+
+#endif // __POSITION_SET_H__
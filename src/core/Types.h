@@ -1,11 +1,15 @@
 #ifndef __TYPES_H__
 #define __TYPES_H__
 
-enum Colour
+#include <cstdint>
+
+// Border is only used internally by the board to mark the points around its edge.
+enum Colour : uint8_t
 {
     None,
     Black,
-    White
+    White,
+    Border
 };
 
 typedef int MoveInfo;
@@ -7,6 +7,7 @@
 #include <cassert>
 
 // Zobrist keys for stones of each colour in each location.
+// Locations are indices into the board's padded arrays.
 class Zobrist
 {
 public:
@@ -25,7 +26,7 @@ public:
     inline uint64_t Key(Colour col, int loc) const 
     {
         assert(col != None);
-        assert(loc < MaxBoardArea);
+        assert(loc < MaxPaddedArea);
         return _keys[(int)col-1][loc]; 
     }
 
@@ -36,7 +37,7 @@ private:
     uint64_t _blackTurn;
 
     // Need a hash key for each colour in each location.
-    uint64_t _keys[2][MaxBoardArea];
+    uint64_t _keys[2][MaxPaddedArea];
 
     Zobrist()
     {
@@ -45,7 +46,7 @@ private:
         _blackTurn = gen.Next();
         for (int col = 0; col < 2; col++)
         {
-            for (int loc = 0; loc < MaxBoardArea; loc++)
+            for (int loc = 0; loc < MaxPaddedArea; loc++)
             {
                 _keys[col][loc] = gen.Next();
             }
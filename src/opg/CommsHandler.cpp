@@ -92,31 +92,50 @@ bool CommsHandler::Process(const std::string& message)
         else if (command == "play")
         {
             // A move was specified.
+            // Boards can't be set up from games longer than this, so refuse to go any further.
             std::string move = tokens[i] + " " + tokens[i+1];
-            _history.AddMove(StringToMove(move, _boardSize));
-            SuccessResponse(id, "");
+            if ((int)_history.Size() < MaxGameLength)
+            {
+                _history.AddMove(StringToMove(move, _boardSize));
+                SuccessResponse(id, "");
+            }
+            else
+            {
+                FailureResponse(id, "game too long");
+            }
+        }
+        else if (command == "genmove" && (int)_history.Size() >= MaxGameLength)
+        {
+            // There's no room to play another move.
+            FailureResponse(id, "game too long");
         }
         else if (command == "genmove")
         {
             // Construct the current board state.
             std::string colString = utils.ToLower(tokens[i]);
             Colour col = colString == "black" || colString == "b" ? Black : White;
-            Board board(col, _boardSize, _history);
+            const TimeInfo& timeInfo = _timeInfos[(int)col-1];
+            int timeForMove = timeInfo.TimeForMove(_boardSize, _history.Size());
+
+            // Use the search which is specialised for this board size (if there is one).
+            MoveStats best = DispatchBoardSize(_boardSize, [&]<int N>()
+            {
+                Board<N> board(col, _boardSize, _history);
 
-            Log(board.ToString());
+                Log(board.ToString());
 
-            // Search for a fixed amount of time.
-            CurrentSearch search;
-            search.Start(board);
+                // Search for a fixed amount of time.
+                CurrentSearch<N> search;
+                search.Start(board);
 
-            const TimeInfo& timeInfo = _timeInfos[(int)col-1];
-            int timeForMove = timeInfo.TimeForMove(_boardSize, _history.Size());
-            Log("TimeForMove: " + std::to_string(timeForMove));
-            std::chrono::milliseconds searchTime(timeForMove);
-            std::this_thread::sleep_for(searchTime);
-            search.Stop();
+                Log("TimeForMove: " + std::to_string(timeForMove));
+                std::chrono::milliseconds searchTime(timeForMove);
+                std::this_thread::sleep_for(searchTime);
+                search.Stop();
+
+                return search.Best();
+            });
 
-            const MoveStats& best = search.Best();
             const Move& move = best.LastMove;
             double winRate = best.WinningChance();
 
@@ -52,54 +52,6 @@ void PatternMatcher::CleanUp()
     }
 }
 
-// Check whether the specified location on the board matches one of the nxn patterns.
-bool PatternMatcher::HasMatch(const Board& board, int patternSize, int loc) const
-{
-    const Colour CurrentPlayer = board.ColourToMove();
-    return HasMatch(board, CurrentPlayer, patternSize, loc);
-}
-
-bool PatternMatcher::HasMatch(const Board& board, Colour colourToMove, int patternSize, int loc) const
-{
-    const int BoardSize = board.Size();
-    BoardSpiral& sp = _boardSpirals[patternSize];
-
-    PatternState* current = &_roots[patternSize];
-
-    int currentRow, currentCol;
-    int row = loc / BoardSize;
-    int col = loc % BoardSize;
-    bool onBoard;
-    for (size_t i = 0; i < sp.Size(); i++)
-    {
-        auto next = sp[i];
-        currentRow = row + next.first;
-        currentCol = col + next.second;
-
-        // What is the location type on the board at this point.
-        onBoard = currentRow >= 0 && currentRow < BoardSize &&
-                  currentCol >= 0 && currentCol < BoardSize;
-
-        Location type = OffBoard;
-        if (onBoard)
-        {
-            int loc = currentRow*BoardSize + currentCol;
-            Colour col = board.PointColour(loc);
-            type = col == None ? Empty
-                : col == colourToMove ? Player
-                : Opponent;
-        }
-
-        current = current->Child(type);
-        if (current->NumPatterns() == 0)
-        {
-            return false;
-        }
-    }
-
-    return true;
-}
-
 void PatternMatcher::InitialiseSpirals()
 {
     _boardSpirals = new BoardSpiral[MaxPatternSize+1];
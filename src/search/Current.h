@@ -2,5 +2,6 @@
 #include "Selection/MCRavePriors.h"
 #include "Playout/BiasedBestOf.h"
 
-// This typedef defines the best search type found so far.
-typedef Search<MCRavePriors, BiasedBestOf<4>> CurrentSearch;
+// This alias defines the best search type found so far for each board size.
+template<int N>
+using CurrentSearch = Search<MCRavePriors, BiasedBestOf<4>, N>;
@@ -2,105 +2,317 @@
 #define __NODE_H__
 
 #include "core/Move.h"
+#include "core/MoveBuffer.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <iostream>
-#include <mutex>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
 
-// The statistics for the move.
+// A snapshot of the statistics for a move, which is how the search reports its results.
+// It isn't stored in the tree (ChildStats keeps the live counters in arrays) so it isn't packed.
 struct MoveStats
 {
     Move LastMove;
-    int Visits;
-    int Wins;
+    int Visits = 0;
+    int Wins = 0;
 
-    int RaveVisits;
-    int RaveWins;
+    int RaveVisits = 0;
+    int RaveWins = 0;
 
-    bool Prioritised;
+    // Get the probability of winning for this node.
+    double WinningChance() const
+    {
+        return (double)Wins / Visits;
+    }
+};
+
+struct Node;
+
+// The statistics for a block of a node's children.
+// These are stored as parallel arrays in one block rather than in the children themselves, so that
+// selection streams through dense arrays instead of visiting each child in turn.
+// A node starts with children for only its most promising moves and is widened as it gets more
+// visits. Each widening adds another block, so the blocks form a list which only grows at its end.
+// The counters are updated by every TreeWorker without locking, so they are atomic. Each counter
+// is consistent on its own, but a reader may see one counter updated before another.
+struct ChildStats
+{
+    Node* Owner; // The node whose children these are.
+    int Count;
+    int Width; // The number of children in this block and the ones before it.
+
+    std::atomic<ChildStats*> Next; // The block which was added when the node was next widened.
+
+    // Set once no more children can be added after this block, either because a worker has
+    // claimed the widening or because every move already has a child.
+    std::atomic<bool> Closed;
+
+    Move* Moves;
+    std::atomic<int>* Visits;
+    std::atomic<int>* Wins;
+
+    std::atomic<int>* RaveVisits;
+    std::atomic<int>* RaveWins;
+
+    Node* Nodes; // The child nodes, which are only needed when descending into them.
+
+    std::atomic<bool> Prioritised;
+
+    // Get the block after this one, if it has been published yet.
+    ChildStats* GetNext() const
+    {
+        return Next.load(std::memory_order_acquire);
+    }
+
+    // Get a snapshot of the specified child's statistics.
+    MoveStats Get(int i) const
+    {
+        return { Moves[i], Visits[i], Wins[i], RaveVisits[i], RaveWins[i] };
+    }
 
     // Add a virtual loss.
-    void VirtualLoss()
+    void VirtualLoss(int i)
     {
-        ++Visits;
+        ++Visits[i];
     }
 
     // Add a virtual win.
-    void VirtualWin()
+    void VirtualWin(int i)
     {
-        --Visits;
+        --Visits[i];
     }
 
     // Update with the new score.
-    void UpdateScore(int score)
+    void UpdateScore(int i, int score)
     {
-        ++Visits;
-
-        bool win = (LastMove.Col == Black && score > 0) ||
-                   (LastMove.Col == White && score < 0);
-
-        Wins += win ? 1 : 0;
+        ++Visits[i];
+        if (IsWin(i, score)) ++Wins[i];
     }
 
     // Update the rave score.
-    void UpdateRaveScore(int score)
+    void UpdateRaveScore(int i, int score)
     {
-        ++RaveVisits;
-
-        bool win = (LastMove.Col == Black && score > 0) ||
-                   (LastMove.Col == White && score < 0);
-
-        RaveWins += win ? 1 : 0;
+        ++RaveVisits[i];
+        if (IsWin(i, score)) ++RaveWins[i];
     }
 
-    // Get the probability of winning for this node.
-    double WinningChance() const
+    // Check whether the score is a win for the player who made the specified move.
+    bool IsWin(int i, int score) const
     {
-        return (double)Wins / Visits;
+        return (Moves[i].Col() == Black && score > 0) ||
+               (Moves[i].Col() == White && score < 0);
     }
 };
 
+// The stages of expanding a node.
+enum class Expansion : int
+{
+    Unexpanded,
+    Expanding,
+    Expanded
+};
+
+class NodeArena;
+
 // A node in the dynamically generated MCTS tree.
+// The node's own statistics are held by its parent (see ChildStats), so the node only links the
+// tree together.
+// The tree is shared by the TreeWorkers without any locks. A node is only expanded once: the
+// worker which claims the expansion fills in the first block of children and then publishes them.
+// After that a block never changes, apart from more blocks being published after the last one when
+// the node is widened. So the children can only be used once HasChildren is true.
+// Nodes are allocated from arenas and never destroyed individually, so they don't own anything.
 struct Node
 {
-    MoveStats Stats;
-    Node* Parent;
-    std::vector<Move> Moves; // The moves that are available.
-    std::vector<Node*> Children; // The child nodes.
-    std::mutex Obj; // This is used to synchronise access to the node from each TreeWorker.
+    ChildStats* Siblings; // The statistics which include this node's, held by its parent.
+    ChildStats* Children;
+    std::atomic<Expansion> State;
+    int Index; // The position of this node's statistics in its siblings'.
+
+    inline Node* Parent() const { return Siblings->Owner; }
+
+    inline const Move& LastMove() const { return Siblings->Moves[Index]; }
+
+    inline int Visits() const { return Siblings->Visits[Index]; }
+
+    // Check whether the node has been expanded and has children.
+    bool HasChildren() const
+    {
+        return State.load(std::memory_order_acquire) == Expansion::Expanded && Children->Count > 0;
+    }
+
+    // Try to claim the expansion of this node, which fails if another worker already has.
+    bool StartExpansion()
+    {
+        Expansion expected = Expansion::Unexpanded;
+        return State.compare_exchange_strong(expected, Expansion::Expanding);
+    }
+
+    // Add a child for each of the moves and publish them to the other workers.
+    // If every move has a child then the node is complete and can't be widened.
+    void AddChildren(const MoveBuffer&, NodeArena&, bool complete = true);
+
+    // Get the last block of children which has been published.
+    ChildStats* LastChildren() const
+    {
+        ChildStats* last = Children;
+        while (ChildStats* next = last->GetNext())
+            last = next;
+
+        return last;
+    }
 
-    ~Node()
+    // Try to claim the widening of this node after the last block of children, which fails if
+    // another worker already has or the node can't be widened.
+    bool StartWidening(ChildStats* last)
     {
-        for (size_t i = 0; i < Children.size(); i++)
+        return !last->Closed.load(std::memory_order_relaxed) && !last->Closed.exchange(true);
+    }
+
+    // Add another block of children after the last one for each of the moves.
+    void Widen(ChildStats* last, const MoveBuffer&, NodeArena&, bool complete);
+
+    // Start loading the statistics of the node's children, which the next selection will read.
+    void PrefetchChildren() const
+    {
+#ifdef __GNUC__
+        if (HasChildren())
         {
-            delete Children[i];
+            __builtin_prefetch(Children->Visits);
+            __builtin_prefetch(Children->Wins);
+            __builtin_prefetch(Children->RaveVisits);
+            __builtin_prefetch(Children->RaveWins);
         }
+#endif
     }
+};
 
-    // Check whether the node has children.
-    bool HasChildren() const
+static_assert(std::is_trivially_destructible<Node>::value, "Nodes are never destroyed.");
+static_assert(std::is_trivially_destructible<ChildStats>::value, "Nodes are never destroyed.");
+
+// Allocates the tree in large blocks so that the statistics for each node's children are
+// contiguous.
+// The tree is only released all at once by resetting the arena, which keeps its blocks to be
+// reused by the next search. Each TreeWorker has its own arena so that workers never contend
+// while allocating.
+class NodeArena
+{
+public:
+    // Allocate space for the specified number of contiguous objects, which are left uninitialised.
+    template<typename T>
+    T* Allocate(size_t n)
     {
-        return Children.size() > 0;
+        size_t bytes = n*sizeof(T);
+        assert(bytes <= BlockSize);
+
+        size_t offset = (_used + alignof(T) - 1) & ~(alignof(T) - 1);
+        if (offset + bytes > BlockSize)
+        {
+            ++_block;
+            offset = 0;
+        }
+
+        if (_block == _blocks.size())
+            _blocks.push_back(std::make_unique_for_overwrite<unsigned char[]>(BlockSize));
+
+        _used = offset + bytes;
+        return reinterpret_cast<T*>(&_blocks[_block][offset]);
     }
 
-    void AddChildren()
+    // Allocate the statistics and nodes for children which make each of the moves.
+    ChildStats* AllocateChildren(Node* owner, std::span<const Move> moves)
     {
-        for (const Move& move : Moves)
+        int count = (int)moves.size();
+        ChildStats* children = new (Allocate<ChildStats>(1)) ChildStats;
+        children->Owner = owner;
+        children->Count = count;
+        children->Width = count;
+        children->Next = nullptr;
+        children->Closed = false;
+        children->Prioritised = false;
+
+        children->Moves = Allocate<Move>(count);
+        std::copy(moves.begin(), moves.end(), children->Moves);
+
+        children->Visits = AllocateCounters(count);
+        children->Wins = AllocateCounters(count);
+        children->RaveVisits = AllocateCounters(count);
+        children->RaveWins = AllocateCounters(count);
+
+        children->Nodes = Allocate<Node>(count);
+        for (int i = 0; i < count; i++)
         {
-            Node* next = new Node;
-            next->Stats = { move, 0, 0, 0, 0, false };
-            next->Parent = this;
-            Children.push_back(next);
+            Node* node = new (&children->Nodes[i]) Node;
+            node->Siblings = children;
+            node->Children = nullptr;
+            node->State = Expansion::Unexpanded;
+            node->Index = i;
         }
+
+        return children;
+    }
+
+    // The number of bytes which have been allocated, including any left unused at the ends of
+    // blocks.
+    size_t Size() const
+    {
+        return _block*BlockSize + _used;
+    }
+
+    // Release everything which has been allocated.
+    void Reset()
+    {
+        _block = 0;
+        _used = 0;
+    }
+
+private:
+    // Enough space for the children of many positions.
+    static constexpr size_t BlockSize = 1 << 20;
+
+    std::vector<std::unique_ptr<unsigned char[]>> _blocks;
+    size_t _block = 0;
+    size_t _used = 0;
+
+    std::atomic<int>* AllocateCounters(int count)
+    {
+        std::atomic<int>* counters = Allocate<std::atomic<int>>(count);
+        for (int i = 0; i < count; i++)
+            new (&counters[i]) std::atomic<int>(0);
+
+        return counters;
     }
 };
 
+inline void Node::AddChildren(const MoveBuffer& moves, NodeArena& arena, bool complete)
+{
+    assert(State.load() == Expansion::Expanding);
+    Children = arena.AllocateChildren(this, std::span<const Move>(moves.begin(), moves.size()));
+    Children->Closed = complete;
+    State.store(Expansion::Expanded, std::memory_order_release);
+}
+
+inline void Node::Widen(ChildStats* last, const MoveBuffer& moves, NodeArena& arena, bool complete)
+{
+    assert(last->Closed.load() && last->GetNext() == nullptr);
+    std::span<const Move> span(moves.begin(), moves.size());
+    ChildStats* more = arena.AllocateChildren(this, span);
+    more->Width += last->Width;
+    more->Closed = complete;
+    last->Next.store(more, std::memory_order_release);
+}
+
 // Make the root node for the tree.
-inline Node* MakeRoot()
+// The root has no parent to hold its statistics, so it gets a block of its own.
+inline Node* MakeRoot(NodeArena& arena)
 {
-    Node* root = new Node;
-    root->Stats = {};
-    root->Parent = nullptr;
-    return root;
+    Move none = {};
+    return &arena.AllocateChildren(nullptr, std::span<const Move>(&none, 1))->Nodes[0];
 }
 
 #endif // __NODE_H__
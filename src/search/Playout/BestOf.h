@@ -2,6 +2,7 @@
 #define __BEST_OF_N_PLAYOUT_POLICY_H__
 
 #include "PlayoutPolicy.h"
+#include "core/MoveBuffer.h"
 #include "core/RandomGenerator.h"
 #include <cfloat>
 
@@ -11,19 +12,20 @@ class BestOf : public PlayoutPolicy
 {
 public:
     // Randomly select N legal moves and decide which one looks more promising.
-    Move Select(const Board& board, const Move& lastMove)
+    template<int S>
+    Move Select(const Board<S>& board, const Move& lastMove)
     {
         (void)lastMove;
 
         if (board.GameOver())
             return BadMove;
 
-        auto moves = board.GetRandomLegalMoves(N, _gen);
+        board.GetRandomLegalMoves(N, _gen, _moves);
 
         // Assess the randomly selected moves.
         double bestScore = -DBL_MAX;
         Move bestMove = BadMove;
-        for (const Move& move : moves)
+        for (const Move& move : _moves)
         {
             double score = MoveScore(move);
             if (score > bestScore)
@@ -39,6 +41,9 @@ public:
 protected:
     RandomGenerator _gen;
 
+    // Scratch space for the candidate moves, which is reused so that playouts don't allocate.
+    MoveBuffer _moves;
+
 private:
     const double CaptureScore = 10;
     const double AtariScore = 5;
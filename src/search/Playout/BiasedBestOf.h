@@ -13,7 +13,8 @@ class BiasedBestOf : protected BestOf<N>
 {
 public:
     // Randomly select N legal moves and decide which one looks more promising.
-    Move Select(const Board& board, const Move& lastMove)
+    template<int S>
+    Move Select(const Board<S>& board, const Move& lastMove)
     {
         if (board.GameOver())
             return BadMove;
@@ -23,7 +24,7 @@ public:
         // Global capturing move.
         if (BestOf<N>::_gen.NextDouble() < 0.45)
         {
-            bestMove = board.GetRandomMoveAttackingLiberties(1, BestOf<N>::_gen);
+            bestMove = board.GetRandomMoveAttackingLiberties(1, BestOf<N>::_gen, BestOf<N>::_moves);
             if (bestMove != BadMove)
             {
                 return bestMove;
@@ -33,7 +34,7 @@ public:
         // Global saving move.
         if (BestOf<N>::_gen.NextDouble() < 0.55)
         {
-            bestMove = board.GetRandomMoveSaving(BestOf<N>::_gen);
+            bestMove = board.GetRandomMoveSaving(BestOf<N>::_gen, BestOf<N>::_moves);
             if (bestMove != BadMove)
             {
                 return bestMove;
@@ -44,7 +45,8 @@ public:
         if (BestOf<N>::_gen.NextDouble() < 0.55 && lastMove.Coord != PassCoord)
         {
             const MoveInfo Urgent = Capture | Atari;
-            bestMove = board.GetRandomMoveLocal(lastMove.Coord, Urgent, BestOf<N>::_gen);
+            bestMove = board.GetRandomMoveLocal(
+                lastMove.Coord, Urgent, BestOf<N>::_gen, BestOf<N>::_moves);
             if (bestMove != BadMove)
             {
                 return bestMove;
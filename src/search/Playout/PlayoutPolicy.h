@@ -6,10 +6,12 @@
 
 // A playout policy defines a method which attempts to select the most promising move during
 // a playout.
+// Select is templated on the board size, so policies hide it rather than overriding it.
 class PlayoutPolicy
 {
 public:
-    virtual Move Select(const Board& board, const Move& lastMove)
+    template<int N>
+    Move Select(const Board<N>& board, const Move& lastMove)
     {
         (void)lastMove;
         return board.GetMoves(true)[0];
@@ -8,25 +8,33 @@ class Uniform : public PlayoutPolicy
 {
 public:
     // Choose a move using uniform random distribution.
-    Move Select(const Board& board, const Move& lastMove)
+    template<int S>
+    Move Select(const Board<S>& board, const Move& lastMove)
     {
         if (board.GameOver())
             return BadMove;
 
         // Try and pick a legal move by guessing to save generating all legal moves.
         const int NumTries = 4;
-        int boardArea = board.Size() * board.Size();
         Colour col = board.ColourToMove();
-        for (int i = 0; i < NumTries; i++)
+        for (int i = 0; i < NumTries && board.NumEmpty() > 0; i++)
         {
-            int coord = _gen.Next(boardArea);
+            int coord = board.GetRandomEmptyCoord(_gen);
             MoveInfo info = board.CheckMove(coord);
             if ((info & Legal) && !(info & FillsEye))
                 return { col, coord };
         }
 
-        auto moves = board.GetMoves(true);
-        return moves[_gen.Next(moves.size())];
+        // Otherwise draw from the legal moves which don't fill eyes, passing if there are none.
+        auto masks = board.GetMoveMasks();
+        BitSet<S> candidates(masks.Legal);
+        candidates.UnSet(masks.FillsEye);
+        int numCandidates = candidates.Count();
+        if (numCandidates == 0)
+            return { col, PassCoord, Legal };
+
+        BitSelector selector(candidates);
+        return { col, board.ToCoord(selector[_gen.Next(numCandidates)]), Legal };
     }
 
 private:
@@ -15,7 +15,8 @@
 // The template parameters are:
 // SP: The selection policy to be used.
 // PP: The playout policy to be used.
-template<class SP, class PP>
+// N: The board size (see Board).
+template<class SP, class PP, int N>
 class Search
 {
 static_assert(std::is_base_of<SelectionPolicy, SP>::value, "Not a valid selection policy.");
@@ -32,26 +33,30 @@ public:
         }
     }
 
-    ~Search()
+    // Use the specified number of threads.
+    Search(int numWorkers) : _numWorkersToUse(numWorkers)
     {
-        if (_root != nullptr)
-        {
-            delete _root;
-            _root = nullptr;
-        }
+        assert(numWorkers > 0);
     }
 
     inline MoveStats Best() const { return _best; }
 
     inline int TreeSize() const { return _treeSize; }
 
+    inline size_t TreeMemory() const { return _treeMemory; }
+
     // Kick off the searching threads.
-    void Start(const Board& pos)
+    void Start(const Board<N>& pos)
     {
+        // Release the previous tree all at once, keeping the arenas' memory for the new one.
+        // Each worker has its own arena, and the first one also holds the root.
+        while ((int)_arenas.size() < _numWorkersToUse)
+            _arenas.push_back(std::make_unique<NodeArena>());
+
+        for (auto& arena : _arenas) arena->Reset();
+
         // Create the root of the tree.
-        if (_root != nullptr) delete _root;
-        _root = MakeRoot();
-        _root->Moves = pos.GetMoves();
+        _root = MakeRoot(*_arenas[0]);
 
         // Create a PRNG which is used to seed each worker's PRNG.
         RandomGenerator seeder;
@@ -61,8 +66,8 @@ public:
 
         for (int i = 0; i < _numWorkersToUse; i++)
         {
-            auto worker = std::make_unique<TreeWorker<SP, PP>>(
-                pos, _root, seeder.Next());
+            auto worker = std::make_unique<TreeWorker<SP, PP, N>>(
+                pos, _root, *_arenas[i], seeder.Next());
             _workers.push_back(std::move(worker));
         }
 
@@ -83,25 +88,35 @@ private:
 
     bool _stop = false;
     Node* _root = nullptr;
-    std::vector<std::unique_ptr<TreeWorker<SP, PP>>> _workers;
+    std::vector<std::unique_ptr<NodeArena>> _arenas;
+    std::vector<std::unique_ptr<TreeWorker<SP, PP, N>>> _workers;
 
     int _treeSize = 0;
+    size_t _treeMemory = 0;
     MoveStats _best;
 
     void CollateResults()
     {
+        _treeMemory = 0;
+        for (auto& arena : _arenas) _treeMemory += arena->Size();
+
+        if (!_root->HasChildren()) return;
+
         // Find the most promising move and cache stats.
         int highestVisits = -1;
-        for (size_t i = 0; i < _root->Children.size(); i++)
+        for (ChildStats* block = _root->Children; block != nullptr; block = block->GetNext())
         {
-            Node const* const child = _root->Children[i];
-            if (child->Stats.Visits > highestVisits)
+            for (int i = 0; i < block->Count; i++)
             {
-                highestVisits = child->Stats.Visits;
-                _best = child->Stats;
+                MoveStats stats = block->Get(i);
+                if (stats.Visits > highestVisits)
+                {
+                    highestVisits = stats.Visits;
+                    _best = stats;
+                }
+
+                _treeSize += stats.Visits;
             }
-
-            _treeSize += child->Stats.Visits;
         }
     }
 };
@@ -1,50 +1,56 @@
 #ifndef __MC_RAVE_H__
 #define __MC_RAVE_H__
 
+#include <algorithm>
 #include <cmath>
 
 class MCRave : SelectionPolicy
 {
 public:
-    Node* Select(const std::vector<Node*>& children) const
+    Node* Select(ChildStats& children) const
     {
-        auto score = std::bind(&MCRave::NodeScore, *this, std::placeholders::_1);
-        return ArgMax<Node>(children, score);
+        return ArgMax(children, [&](const ChildStats& block, int start, int n, float* scores)
+        {
+            ScoreBatch(block, start, n, scores);
+        });
     }
 
 private:
     // This constant defines the cross-over point where the weight of the MC values and the RAVE
     // values is equal.
-    const int K = 1000;
+    static constexpr int K = 1000;
 
-    double MCVal(Node* const n) const
+    static float Beta(int visits)
     {
-        const MoveStats& stats = n->Stats;
-        return stats.Visits > 0 ? (double)stats.Wins / stats.Visits : 0;
+        return visits > 0 ? sqrt((double)K / (3*visits + K)) : 1;
     }
 
-    double RaveVal(Node* const n) const
-    {
-        const MoveStats& stats = n->Stats;
-        return stats.RaveVisits > 0 ? (double)stats.RaveWins / stats.RaveVisits : 0;
-    }
+    static inline const VisitTable<Beta> BetaTable;
 
-    double Beta(Node* const n) const
+    // Blend the MC and RAVE values for each child in the batch.
+    // A child without any visits has no wins either, so dividing by at least one visit gives the
+    // zero value without a branch in the loop which does the arithmetic.
+    void ScoreBatch(const ChildStats& children, int start, int n, float* scores) const
     {
-        double b = 1;
-        const MoveStats& stats = n->Stats;
-        if (stats.Visits > 0)
+        alignas(32) float visits[BatchSize], wins[BatchSize];
+        alignas(32) float raveVisits[BatchSize], raveWins[BatchSize];
+        alignas(32) float beta[BatchSize];
+        for (int i = 0; i < n; i++)
         {
-            b = sqrt((double)K / (3*stats.Visits + K));
+            int v = children.Visits[start+i];
+            visits[i] = std::max(v, 1);
+            wins[i] = children.Wins[start+i];
+            raveVisits[i] = std::max((int)children.RaveVisits[start+i], 1);
+            raveWins[i] = children.RaveWins[start+i];
+            beta[i] = BetaTable(v);
         }
 
-        return b;
-    }
-
-    double NodeScore(Node* const n) const
-    {
-        double b = Beta(n);
-        return (1-b)*MCVal(n) + b*RaveVal(n);
+        for (int i = 0; i < n; i++)
+        {
+            float mcVal = wins[i] / visits[i];
+            float raveVal = raveWins[i] / raveVisits[i];
+            scores[i] = (1-beta[i])*mcVal + beta[i]*raveVal;
+        }
     }
 };
 
@@ -9,13 +9,9 @@
 class MCRavePriors : public MCRave
 {
 public:
-    Node* Select(const std::vector<Node*>& children) const
+    Node* Select(ChildStats& children) const
     {
-        for (Node* const c : children)
-        {
-            PriorUpdateAll(c->Stats);
-        }
-
+        PriorUpdateAll(children);
         return MCRave::Select(children);
     }
 
@@ -30,25 +26,31 @@ private:
     Prior SelfAtariPrior = { 20, 0 };
     Prior LocalPrior = { 30, 30 };
 
-    void PriorUpdateAll(MoveStats& stats) const
+    void PriorUpdateAll(ChildStats& children) const
     {
-        if (!stats.Prioritised)
+        for (ChildStats* block = &children; block != nullptr; block = block->GetNext())
         {
-            PriorUpdate(stats, Capture, CapturePrior);
-            PriorUpdate(stats, Save, SavePrior);
-            PriorUpdate(stats, SelfAtari, SelfAtariPrior);
-            PriorUpdate(stats, Local, LocalPrior);
-            stats.Prioritised = true;
+            // Only the first worker to see each block of children applies the priors.
+            if (!block->Prioritised.exchange(true))
+            {
+                for (int i = 0; i < block->Count; i++)
+                {
+                    PriorUpdate(*block, i, Capture, CapturePrior);
+                    PriorUpdate(*block, i, Save, SavePrior);
+                    PriorUpdate(*block, i, SelfAtari, SelfAtariPrior);
+                    PriorUpdate(*block, i, Local, LocalPrior);
+                }
+            }
         }
     }
 
-    void PriorUpdate(MoveStats& stats, MoveInfo moveType, const Prior& prior) const
+    void PriorUpdate(ChildStats& children, int i, MoveInfo moveType, const Prior& prior) const
     {
-        if (stats.LastMove.Info & moveType)
+        if (children.Moves[i].Info & moveType)
         {
             // Apply the priors to the RAVE values so that they effect early selections.
-            stats.RaveVisits += prior.first;
-            stats.RaveWins += prior.second;
+            children.RaveVisits[i] += prior.first;
+            children.RaveWins[i] += prior.second;
         }
     }
 };
@@ -2,34 +2,78 @@
 #define __SELECTION_POLICY_H__
 
 #include "../Node.h"
+#include <algorithm>
+#include <cassert>
 #include <cfloat>
-#include <vector>
-#include <functional>
+
+// The values of a function of a visit count, so that the selection policies don't have to
+// evaluate square roots and logarithms for every child.
+// Larger counts are rare, so they are calculated directly rather than making the table bigger
+// than the cache can comfortably hold.
+template<float (*F)(int)>
+class VisitTable
+{
+public:
+    VisitTable()
+    {
+        for (int i = 0; i < Size; i++)
+            _values[i] = F(i);
+    }
+
+    inline float operator()(int visits) const
+    {
+        assert(visits >= 0);
+        return visits < Size ? _values[visits] : F(visits);
+    }
+
+private:
+    static constexpr int Size = 1 << 12;
+    float _values[Size];
+};
 
 // A selection policy defines a method which attempts to select the most promising child node.
+// The policy works on the statistics of all of the children at once, given the first block of
+// them, and returns the child to select.
+// The policies are template arguments of the search, so Select isn't virtual: each policy hides
+// it with its own and the scoring is inlined.
 class SelectionPolicy
 {
 public:
-    virtual Node* Select(const std::vector<Node*>& children) const
+    Node* Select(ChildStats& children) const
     {
-        return children[0];
+        return &children.Nodes[0];
     }
 
     virtual ~SelectionPolicy() {}
 
 protected:
-    template<typename T>
-    T* ArgMax(const std::vector<T*>& args, std::function<double(T* const)> score) const
+    // The children are scored in batches of this size.
+    static constexpr int BatchSize = 64;
+
+    // Find the child with the highest score.
+    // The scoring function fills in the scores for a batch of children given their block, the
+    // index of the first one and the size of the batch. Policies copy the counters into plain
+    // arrays first so that the arithmetic can be vectorised over the whole batch.
+    template<typename ScoreBatch>
+    Node* ArgMax(ChildStats& children, ScoreBatch scoreBatch) const
     {
-        T* best = nullptr;
-        double bestVal = -DBL_MAX;
-        for (T* arg : args)
+        Node* best = &children.Nodes[0];
+        float bestVal = -FLT_MAX;
+        alignas(32) float scores[BatchSize];
+        for (ChildStats* block = &children; block != nullptr; block = block->GetNext())
         {
-            double val = score(arg);
-            if (val > bestVal)
+            for (int start = 0; start < block->Count; start += BatchSize)
             {
-                bestVal = val;
-                best = arg;
+                int n = std::min(BatchSize, block->Count - start);
+                scoreBatch(*block, start, n, scores);
+                for (int i = 0; i < n; i++)
+                {
+                    if (scores[i] > bestVal)
+                    {
+                        bestVal = scores[i];
+                        best = &block->Nodes[start + i];
+                    }
+                }
             }
         }
 
@@ -2,6 +2,7 @@
 #define __UCB_SELECTION_POLICY_H__
 
 #include "SelectionPolicy.h"
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 #include <iostream>
@@ -9,37 +10,64 @@
 // UCB selection policy.
 // The template argument is the exploration constant multipled by 100.
 template <unsigned int N>
-class UCB : SelectionPolicy
+class UCB : public SelectionPolicy
 {
 public:
     // Select the most promising child according to the UCB algorithm.
-    Node* Select(const std::vector<Node*>& children) const
+    Node* Select(ChildStats& children) const
     {
-        auto score = std::bind(&UCB::Policy, *this, std::placeholders::_1);
-        return ArgMax<Node>(children, score);
+        return ArgMax(children, [&](const ChildStats& block, int start, int n, float* scores)
+        {
+            ScoreBatch(block, start, n, scores);
+        });
     }
 
 protected:
-    // This method applies the UCB formula.
-    virtual double Policy(Node const * const n) const
+    // This method applies the UCB formula to each child in the batch.
+    // The exploration term is split into a factor for the parent, which is the same for every
+    // child, and one for the child. A child without any visits has no wins either, so its MC value
+    // is found by dividing by at least one visit.
+    void ScoreBatch(const ChildStats& children, int start, int n, float* scores) const
     {
-        int totalVisits = n->Parent->Stats.Visits;
-        return totalVisits > 0
-            ? MCVal(n) + ExplorationTerm(n->Stats.Visits, totalVisits)
-            : 0;
+        int totalVisits = children.Owner->Visits();
+        if (totalVisits <= 0)
+        {
+            std::fill(scores, scores + n, 0.0f);
+            return;
+        }
+
+        float parentTerm = ParentTable(totalVisits);
+
+        alignas(32) float visits[BatchSize], wins[BatchSize], childTerm[BatchSize];
+        for (int i = 0; i < n; i++)
+        {
+            int v = children.Visits[start+i];
+            visits[i] = std::max(v, 1);
+            wins[i] = children.Wins[start+i];
+            childTerm[i] = ChildTable(v);
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            float mcVal = wins[i] / visits[i];
+            scores[i] = mcVal + parentTerm*childTerm[i];
+        }
     }
 
-    double MCVal(Node const * const n) const
+private:
+    // The exploration term is sqrt(N*log(parentVisits) / (100*visits)).
+    static float ParentTerm(int parentVisits)
     {
-        const MoveStats& stats = n->Stats;
-        return stats.Visits > 0 ? (double)stats.Wins / stats.Visits : 0;
+        return sqrt(N*log(parentVisits) / 100.0);
     }
 
-    // Calculate the exploration term.
-    double ExplorationTerm(int visits, int parentVisits) const
+    static float ChildTerm(int visits)
     {
-        return  sqrt(N*log(parentVisits) / (100.0*visits));
+        return 1 / sqrt(visits);
     }
+
+    static inline const VisitTable<ParentTerm> ParentTable;
+    static inline const VisitTable<ChildTerm> ChildTable;
 };
 
 #endif // __UCB_SELECTION_POLICY_H__
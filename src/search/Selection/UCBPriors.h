@@ -7,16 +7,25 @@
 
 class UCBPriors : public UCB1
 {
-protected:
-    virtual double Policy(Node* const n) const
+public:
+    Node* Select(ChildStats& children) const
     {
-        const MoveStats& stats = n->Stats;
-
-        double priorTerm = 0;
-        if (stats.Visits > 0)
-            priorTerm = Prior(stats.LastMove) / stats.Visits;
+        return ArgMax(children, [&](const ChildStats& block, int start, int n, float* scores)
+        {
+            ScoreBatch(block, start, n, scores);
+        });
+    }
 
-        return priorTerm + UCB1::Policy(n);
+protected:
+    void ScoreBatch(const ChildStats& children, int start, int n, float* scores) const
+    {
+        UCB1::ScoreBatch(children, start, n, scores);
+        for (int i = 0; i < n; i++)
+        {
+            int visits = children.Visits[start+i];
+            if (visits > 0)
+                scores[i] += Prior(children.Moves[start+i]) / visits;
+        }
     }
 
 private:
@@ -1,65 +1,91 @@
 #ifndef __TREE_WORKER_H__
 #define __TREE_WORKER_H__
 
+#include "core/Args.h"
 #include "core/Board.h"
 #include "Node.h"
 #include "Playout/PlayoutPolicy.h"
 #include "Selection/SelectionPolicy.h"
 #include "core/RandomGenerator.h"
-#include <mutex>
+#include <algorithm>
+#include <atomic>
 #include <thread>
 #include "lurien.h"
 
 // This class performs the MCTS algorithm to find the best move.
 // It contains the code that is executed by each worker thread.
-template<class SP, class PP>
+// N is the board size (see Board).
+template<class SP, class PP, int N>
 class TreeWorker
 {
 public:
-    TreeWorker(const Board& pos, Node* root, uint64_t seed) : _pos(&pos)
+    TreeWorker(const Board<N>& pos, Node* root, NodeArena& arena, uint64_t seed)
+        : _pos(&pos), _arena(&arena)
     {
         _root = root;
         _gen = std::make_unique<RandomGenerator>(seed);
         _sp = std::make_unique<SP>();
         _pp = std::make_unique<PP>();
+
+        // Optionally only check simple ko during playouts.
+        auto args = Args::Get();
+        _simpleKoPlayouts = args != nullptr && args->HasArg("-simpleko");
+    }
+
+    ~TreeWorker()
+    {
+        Stop();
     }
 
     // Start a searching thread.
     void Start()
     {
         _stop = false;
-        std::thread worker([&] { DoSearch(); });
-        worker.detach();
+        _thread = std::thread([&] { DoSearch(); });
     }
 
     // Stop the currently executing search.
+    // This waits for the thread to finish, so the worker and the position can then be destroyed.
     void Stop()
     {
         _stop = true;
-
-        // Block until the mutex is available.
-        std::unique_lock<std::mutex> lock(_mtx);
+        if (_thread.joinable())
+            _thread.join();
     }
 
 private:
-    bool _stop = false;
+    std::atomic<bool> _stop = false;
+    bool _simpleKoPlayouts = false;
     Node* _root;
     std::unique_ptr<SP> _sp;
     std::unique_ptr<PP> _pp;
     std::unique_ptr<RandomGenerator> _gen;
-    Board const* _pos;
-    std::mutex _mtx;
+    Board<N> const* _pos;
+    std::thread _thread;
+
+    // The arena which this worker allocates nodes from when it expands them.
+    NodeArena* _arena;
+
+    // Scratch space for the moves of the node being expanded and the ones which are chosen to
+    // become its children.
+    MoveBuffer _moves;
+    MoveBuffer _chosen;
+
+    // A node starts with children for this many of its most promising moves.
+    const int InitialWidth = 8;
+
+    // A node is widened once it has had this many visits for each of its children, and each
+    // widening doubles the number of children.
+    const int VisitsPerChild = 2;
 
     // This method keeps searching until a call to Stop is made.
     void DoSearch()
     {
         LURIEN_SCOPE(search)
 
-        std::unique_lock<std::mutex> lock(_mtx);
-
         int boardSize = _pos->Size();
         int boardArea = boardSize*boardSize;
-        Board temp(_pos->Size());
+        Board<N> temp(_pos->Size());
         Colour* playerOwned = new Colour[boardArea];
         while (!_stop)
         {
@@ -72,7 +98,7 @@ private:
             Node* leaf = SelectNode(temp, playerOwned);
 
             // Perform a playout and record the result.
-            int res = Simulate(temp, leaf->Stats.LastMove, playerOwned);
+            int res = Simulate(temp, leaf->LastMove(), playerOwned);
 
             // Backpropagate the scores.
             UpdateScores(leaf, playerOwned, res);
@@ -81,7 +107,7 @@ private:
         delete[] playerOwned;
     }
 
-    Node* SelectNode(Board& temp, Colour* playerOwned) const
+    Node* SelectNode(Board<N>& temp, Colour* playerOwned)
     {
         LURIEN_SCOPE(select)
 
@@ -95,16 +121,25 @@ private:
     }
 
     // Select a node to expand.
-    Node* Select(Board& temp, Node* root, Colour* playerOwned) const
+    Node* Select(Board<N>& temp, Node* root, Colour* playerOwned)
     {
         Node* current = root;
-        while (current->Stats.Visits >= (int)current->Children.size() && current->HasChildren())
+        while (current->HasChildren())
         {
-            std::lock_guard<std::mutex> lk(current->Obj);
-            current = _sp->Select(current->Children);
-            current->Stats.VirtualLoss();
+            ChildStats* last = current->LastChildren();
+            int visits = current->Visits();
+
+            // Simulate from the node itself until there have been enough visits for its children.
+            if (visits < last->Width)
+                break;
+
+            // Add more children once the node has been visited enough for the ones it has.
+            if (visits >= VisitsPerChild*last->Width && current->StartWidening(last))
+                Widen(temp, current, last);
 
-            const Move& move = current->Stats.LastMove;
+            current = SelectChild(current);
+
+            const Move& move = current->LastMove();
             temp.MakeMove(move);
 
             // Update the ownership map.
@@ -115,24 +150,25 @@ private:
     }
 
     // Expand the chosen leaf node.
-    Node* Expand(Board& temp, Node* leaf, Colour* playerOwned) const
+    Node* Expand(Board<N>& temp, Node* leaf, Colour* playerOwned)
     {
         LURIEN_SCOPE(expand)
 
+        // If another worker has already expanded the leaf (or is doing so) then simulate from the
+        // leaf itself.
         Node* expanded = leaf;
-        std::lock_guard<std::mutex> lk(expanded->Obj);
-        if (!expanded->HasChildren())
+        if (expanded->StartExpansion())
         {
-            expanded->Moves = temp.GetMoves();
-            expanded->AddChildren();
+            temp.GetMoves(_moves);
+            bool complete = ChooseMoves(expanded, InitialWidth);
+            expanded->AddChildren(_chosen, *_arena, complete);
 
             if (expanded->HasChildren())
             {
                 // Select the best according to the priors.
-                expanded = _sp->Select(expanded->Children);
-                expanded->Stats.VirtualLoss();
+                expanded = SelectChild(expanded);
 
-                const Move& move = expanded->Stats.LastMove;
+                const Move& move = expanded->LastMove();
                 temp.MakeMove(move);
 
                 // Update the ownership map.
@@ -143,11 +179,98 @@ private:
         return expanded;
     }
 
+    // Add children for as many more moves as the node already has children for.
+    void Widen(const Board<N>& temp, Node* node, ChildStats* last)
+    {
+        LURIEN_SCOPE(widen)
+
+        temp.GetMoves(_moves);
+        bool complete = ChooseMoves(node, last->Width);
+        if (!_chosen.empty())
+            node->Widen(last, _chosen, *_arena, complete);
+    }
+
+    // Choose up to the specified number of the most promising moves which the node doesn't
+    // already have children for, and return whether these are all of the remaining moves.
+    // Moves which are equally promising are taken in a random order so that the children aren't
+    // biased towards one side of the board.
+    bool ChooseMoves(const Node* node, int n)
+    {
+        bool hasChild[MaxBoardArea+1] = {}; // The last entry is for passing.
+        if (node->HasChildren())
+        {
+            for (ChildStats* block = node->Children; block != nullptr; block = block->GetNext())
+            {
+                for (int i = 0; i < block->Count; i++)
+                    hasChild[MoveIndex(block->Moves[i])] = true;
+            }
+        }
+
+        // The random bits are below the priority so that they only break ties.
+        std::pair<int64_t, Move> candidates[MoveBuffer::Capacity];
+        int numCandidates = 0;
+        for (const Move& move : _moves)
+        {
+            if (!hasChild[MoveIndex(move)])
+            {
+                int64_t key = ((int64_t)Priority(move) << 32) | (_gen->Next() & 0xFFFFFFFF);
+                candidates[numCandidates++] = { key, move };
+            }
+        }
+
+        n = std::min(n, numCandidates);
+        std::partial_sort(candidates, candidates + n, candidates + numCandidates,
+            [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        _chosen.clear();
+        for (int i = 0; i < n; i++)
+            _chosen.push_back(candidates[i].second);
+
+        return n == numCandidates;
+    }
+
+    // The index of the move in a map of the board's points followed by passing.
+    int MoveIndex(const Move& move) const
+    {
+        return move.Coord == PassCoord ? MaxBoardArea : move.Coord;
+    }
+
+    // Rank the move for the order in which children are added, using the same properties as the
+    // priors. Passing is only considered once nothing else is promising.
+    int Priority(const Move& move) const
+    {
+        if (move.Coord == PassCoord)
+            return -2;
+
+        MoveInfo info = move.Info;
+        int priority = 0;
+        if (info & Capture) ++priority;
+        if (info & Save) ++priority;
+        if (info & Local) ++priority;
+        if (info & SelfAtari) --priority;
+
+        return priority;
+    }
+
+    // Select the most promising child of the node and give it a virtual loss.
+    Node* SelectChild(Node* node) const
+    {
+        Node* child = _sp->Select(*node->Children);
+        child->Siblings->VirtualLoss(child->Index);
+
+        // The child's own children are likely to be selected from next.
+        child->PrefetchChildren();
+        return child;
+    }
+
     // Perform a simulation from the specified game state.
-    int Simulate(Board& temp, const Move& lastMove, Colour* playerOwned) const
+    int Simulate(Board<N>& temp, const Move& lastMove, Colour* playerOwned) const
     {
         LURIEN_SCOPE(simulate)
 
+        if (_simpleKoPlayouts)
+            temp.EnterPlayoutMode();
+
         // Make moves according to the playout policy until a terminal state is reached.
         Move move = lastMove;
         while ((move = _pp->Select(temp, move)) != BadMove)
@@ -165,7 +288,7 @@ private:
         int coord = move.Coord;
         if (coord != PassCoord && playerOwned[coord] == None)
         {
-            playerOwned[coord] = move.Col;
+            playerOwned[coord] = move.Col();
         }
     }
 
@@ -177,21 +300,19 @@ private:
         // Backtrack the scores up the tree.
         while (leaf != nullptr)
         {
-            std::lock_guard<std::mutex> lk(leaf->Obj);
-
             // RAVE update all children of leaf.
             RaveUpdate(leaf, playerOwned, score);
 
-            MoveStats& stats = leaf->Stats;
+            ChildStats& stats = *leaf->Siblings;
 
             // Reverse the effects of virtual losses.
-            stats.VirtualWin();
-            stats.UpdateScore(score);
-            leaf = leaf->Parent;
+            stats.VirtualWin(leaf->Index);
+            stats.UpdateScore(leaf->Index, score);
+            leaf = leaf->Parent();
         }
 
         // Give the root node a visit (some selection policies need this).
-        _root->Stats.Visits++;
+        _root->Siblings->Visits[_root->Index]++;
     }
 
     // The RAVE update effects all children of this node.
@@ -200,18 +321,20 @@ private:
     void RaveUpdate(Node* node, Colour* playerOwned, int score) const
     {
         // Update the node if possible.
-        if (node != nullptr)
+        if (node != nullptr && node->HasChildren())
         {
-            for (Node* child : node->Children)
+            for (ChildStats* block = node->Children; block != nullptr; block = block->GetNext())
             {
-                // Update this child's stats.
-                MoveStats& stats = child->Stats;
-                int coord = stats.LastMove.Coord;
-                Colour col = stats.LastMove.Col;
-                if (coord != PassCoord && playerOwned[coord] == col)
+                for (int i = 0; i < block->Count; i++)
                 {
-                    // This is valid evidence for the node.
-                    stats.UpdateRaveScore(score);
+                    // Update this child's stats.
+                    int coord = block->Moves[i].Coord;
+                    Colour col = block->Moves[i].Col();
+                    if (coord != PassCoord && playerOwned[coord] == col)
+                    {
+                        // This is valid evidence for the node.
+                        block->UpdateRaveScore(i, score);
+                    }
                 }
             }
         }
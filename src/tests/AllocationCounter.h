@@ -0,0 +1,11 @@
+#ifndef __ALLOCATION_COUNTER_H__
+#define __ALLOCATION_COUNTER_H__
+
+#include <cstdint>
+
+// The number of heap allocations which have been made through the global operator new.
+// The test executable replaces operator new so that benchmarks can check how often the code
+// under test allocates.
+uint64_t NumAllocations();
+
+#endif // __ALLOCATION_COUNTER_H__
@@ -0,0 +1,347 @@
+#ifndef __BENCHMARK_TEST_H__
+#define __BENCHMARK_TEST_H__
+
+#include "TestBase.h"
+#include "AllocationCounter.h"
+#include "core/Board.h"
+#include "core/Move.h"
+#include "core/RandomGenerator.h"
+#include "core/Utils.h"
+#include "search/Current.h"
+#include "search/Playout/BiasedBestOf.h"
+#include "search/Selection/MCRavePriors.h"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+// Micro-benchmarks for the board operations that dominate the search.
+class BenchmarkTest : public TestBase
+{
+public:
+    std::string TestFileName() const
+    {
+        return "BenchmarkTests.suite";
+    }
+
+    // Parse the lines describing the test and execute it.
+    bool Run(const std::vector<std::string>& lines)
+    {
+        // There should be one line containing the benchmark name, board size and duration.
+        assert(lines.size() == 1);
+        Utils utils;
+        auto split = utils.Split(lines[0], ' ');
+        assert(split.size() == 3);
+
+        std::string name = split[0];
+        int boardSize = stoi(split[1]);
+        int duration = stoi(split[2]);
+
+        return RunTest(name, boardSize, duration);
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // The fraction of the board which is filled before a benchmark starts.
+    const double FillFraction = 0.6;
+
+    bool RunTest(const std::string& name, int boardSize, int duration) const
+    {
+        return DispatchBoardSize(boardSize, [&]<int N>()
+        {
+            // Scoring happens at the end of a playout so play the game out fully in that case,
+            // whereas playouts start from the empty board. Selection also uses the empty board,
+            // where there are the most children to choose from.
+            Board<N> board(boardSize);
+            bool playout = name == "Playout" || name == "SimpleKoPlayout" || name == "Scaling" ||
+                           name == "Selection";
+            FillBoard(board, name == "Score" ? 1 : playout ? 0 : FillFraction);
+            std::cout << board.ToString() << std::endl;
+
+            bool pass = true;
+            if (name == "Clone")
+            {
+                Clones(board, duration);
+            }
+            else if (name == "Score")
+            {
+                Scores(board, duration);
+            }
+            else if (name == "Undo")
+            {
+                Undos(board, duration);
+            }
+            else if (name == "Moves")
+            {
+                GenerateMoves(board, duration);
+            }
+            else if (name == "Masks")
+            {
+                GenerateMasks(board, duration);
+            }
+            else if (name == "Playout")
+            {
+                Playouts(board, duration, false);
+            }
+            else if (name == "SimpleKoPlayout")
+            {
+                Playouts(board, duration, true);
+            }
+            else if (name == "Scaling")
+            {
+                Scaling(board, duration);
+            }
+            else if (name == "Selection")
+            {
+                Selections(board, duration);
+            }
+            else
+            {
+                std::cout << "Unknown benchmark: " << name << std::endl;
+                pass = false;
+            }
+
+            return pass;
+        });
+    }
+
+    // Play random moves until the specified fraction of the board has been filled (or the game
+    // is over) so that there is a realistic number of chains.
+    template<int N>
+    void FillBoard(Board<N>& board, double fraction) const
+    {
+        RandomGenerator gen(1070372);
+        int area = board.Size()*board.Size();
+        for (int i = 0; (i < fraction*area || fraction >= 1) && !board.GameOver(); i++)
+        {
+            auto moves = board.GetRandomLegalMoves(1, gen);
+            board.MakeMove(moves[gen.Next(moves.size())]);
+        }
+    }
+
+    // Measure the number of times per second that the position can be cloned.
+    template<int N>
+    void Clones(const Board<N>& board, int duration) const
+    {
+        Board<N> temp(board.Size());
+        const int BatchSize = 1024;
+        uint64_t clones = 0;
+        auto start = Clock::now();
+        auto end = start + std::chrono::seconds(duration);
+        while (Clock::now() < end)
+        {
+            for (int i = 0; i < BatchSize; i++)
+                temp.CloneFrom(board);
+
+            clones += BatchSize;
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        std::cout << "Clones/sec: " << (uint64_t)(clones / elapsed.count()) << std::endl;
+    }
+
+    // Measure the number of times per second that a move can be made and then undone.
+    template<int N>
+    void Undos(Board<N>& board, int duration) const
+    {
+        RandomGenerator gen(1070372);
+        auto moves = board.GetMoves();
+        UndoJournal<N> journal;
+
+        const int BatchSize = 1024;
+        uint64_t undos = 0;
+        auto start = Clock::now();
+        auto end = start + std::chrono::seconds(duration);
+        while (Clock::now() < end)
+        {
+            for (int i = 0; i < BatchSize; i++)
+            {
+                board.MakeMove(moves[gen.Next(moves.size())], journal);
+                board.UnmakeMove(journal);
+            }
+
+            undos += BatchSize;
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        std::cout << "Undos/sec: " << (uint64_t)(undos / elapsed.count()) << std::endl;
+    }
+
+    // Measure the number of times per second that all of the moves can be generated.
+    template<int N>
+    void GenerateMoves(const Board<N>& board, int duration) const
+    {
+        const int BatchSize = 1024;
+        uint64_t generations = 0;
+        size_t numMoves = 0;
+        auto start = Clock::now();
+        auto end = start + std::chrono::seconds(duration);
+        while (Clock::now() < end)
+        {
+            for (int i = 0; i < BatchSize; i++)
+                numMoves = board.GetMoves().size();
+
+            generations += BatchSize;
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        std::cout << "Moves: " << numMoves << std::endl;
+        std::cout << "Generations/sec: " << (uint64_t)(generations / elapsed.count()) << std::endl;
+    }
+
+    // Measure the number of times per second that the move masks can be generated.
+    template<int N>
+    void GenerateMasks(const Board<N>& board, int duration) const
+    {
+        const int BatchSize = 1024;
+        uint64_t generations = 0;
+        size_t numLegal = 0;
+        auto start = Clock::now();
+        auto end = start + std::chrono::seconds(duration);
+        while (Clock::now() < end)
+        {
+            for (int i = 0; i < BatchSize; i++)
+                numLegal = board.GetMoveMasks().Legal.Count();
+
+            generations += BatchSize;
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        std::cout << "Legal: " << numLegal << std::endl;
+        std::cout << "Generations/sec: " << (uint64_t)(generations / elapsed.count()) << std::endl;
+    }
+
+    // Measure the number of playouts per second from the position, using the same playout
+    // policy as the current search.
+    // The board can be put into playout mode, as the search does when only checking simple ko.
+    // The playouts shouldn't need to allocate, so the number of allocations is also reported.
+    template<int N>
+    void Playouts(const Board<N>& board, int duration, bool playoutMode) const
+    {
+        BiasedBestOf<4> policy;
+        Board<N> temp(board.Size());
+        uint64_t playouts = 0;
+        uint64_t allocations = NumAllocations();
+        auto start = Clock::now();
+        auto end = start + std::chrono::seconds(duration);
+        while (Clock::now() < end)
+        {
+            temp.CloneFrom(board);
+            if (playoutMode)
+                temp.EnterPlayoutMode();
+
+            Move move = { None, PassCoord, 0 };
+            while ((move = policy.Select(temp, move)) != BadMove)
+                temp.MakeMove(move);
+
+            temp.Score();
+            ++playouts;
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        allocations = NumAllocations() - allocations;
+        std::cout << "Playouts/sec: " << (uint64_t)(playouts / elapsed.count()) << std::endl;
+        std::cout << "Allocations/playout: " << (double)allocations / playouts << std::endl;
+    }
+
+    // Measure the number of playouts per second which the current search makes from the position
+    // with increasing numbers of threads, up to the number of cores.
+    // The workers share the tree, so this shows how well they avoid getting in each other's way.
+    template<int N>
+    void Scaling(const Board<N>& board, int duration) const
+    {
+        int numCores = std::max(1, (int)std::thread::hardware_concurrency());
+        std::vector<int> threadCounts;
+        for (int threads = 1; threads < numCores; threads *= 2)
+            threadCounts.push_back(threads);
+
+        threadCounts.push_back(numCores);
+
+        double singleThreaded = 0;
+        for (int threads : threadCounts)
+        {
+            CurrentSearch<N> search(threads);
+            search.Start(board);
+            std::this_thread::sleep_for(std::chrono::seconds(duration));
+            search.Stop();
+
+            double playoutsPerSec = (double)search.TreeSize() / duration;
+            if (threads == 1) singleThreaded = playoutsPerSec;
+
+            std::cout << "Threads: " << threads
+                      << " Playouts/sec: " << (uint64_t)playoutsPerSec
+                      << " Speedup: " << playoutsPerSec / singleThreaded << std::endl;
+        }
+    }
+
+    // Measure the number of times per second that the most promising move can be selected from
+    // the position, using the same selection policy as the current search.
+    // The children are given random statistics, as they would have part way through a search.
+    template<int N>
+    void Selections(const Board<N>& board, int duration) const
+    {
+        NodeArena arena;
+        Node* root = MakeRoot(arena);
+        MoveBuffer moves;
+        board.GetMoves(moves);
+        root->StartExpansion();
+        root->AddChildren(moves, arena);
+
+        RandomGenerator gen(1070372);
+        ChildStats& children = *root->Children;
+        int totalVisits = 0;
+        for (int i = 0; i < children.Count; i++)
+        {
+            children.Visits[i] = gen.Next(1000);
+            children.Wins[i] = gen.Next(children.Visits[i] + 1);
+            children.RaveVisits[i] = gen.Next(10000);
+            children.RaveWins[i] = gen.Next(children.RaveVisits[i] + 1);
+            totalVisits += children.Visits[i];
+        }
+
+        root->Siblings->Visits[root->Index] = totalVisits;
+
+        MCRavePriors policy;
+        const int BatchSize = 1024;
+        uint64_t selections = 0;
+        Node* selected = nullptr;
+        auto start = Clock::now();
+        auto end = start + std::chrono::seconds(duration);
+        while (Clock::now() < end)
+        {
+            for (int i = 0; i < BatchSize; i++)
+                selected = policy.Select(children);
+
+            selections += BatchSize;
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        std::cout << "Children: " << children.Count << std::endl;
+        std::cout << "Selected: " << selected->Index << std::endl;
+        std::cout << "Selections/sec: " << (uint64_t)(selections / elapsed.count()) << std::endl;
+    }
+
+    // Measure the number of times per second that the position can be scored.
+    template<int N>
+    void Scores(const Board<N>& board, int duration) const
+    {
+        const int BatchSize = 1024;
+        uint64_t scores = 0;
+        auto start = Clock::now();
+        auto end = start + std::chrono::seconds(duration);
+        while (Clock::now() < end)
+        {
+            for (int i = 0; i < BatchSize; i++)
+                board.Score();
+
+            scores += BatchSize;
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        std::cout << "Margin: " << board.ScoreMargin() << std::endl;
+        std::cout << "Scores/sec: " << (uint64_t)(scores / elapsed.count()) << std::endl;
+    }
+};
+
+#endif // __BENCHMARK_TEST_H__
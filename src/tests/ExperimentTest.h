@@ -64,18 +64,18 @@ private:
     };
 
     // All test cases are 9x9.
-    const int N = 9;
+    static const int N = 9;
 
     // Attempt to solve the tsumego.
     // It is always black to move.
     bool RunTest(Colour col, const std::vector<std::string>& lines, double solution) const
     {
-        Board board(col, lines);
+        Board<N> board(col, lines);
         std::cout << board.ToString() << std::endl;
         CurrentRules.Komi = 7.5;
 
         // Spawn a searching thread for this position.
-        CurrentSearch search;
+        CurrentSearch<N> search;
         search.Start(board);
 
         // Allow the search to continue for 5 seconds.
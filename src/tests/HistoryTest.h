@@ -0,0 +1,120 @@
+#ifndef __HISTORY_TEST_H__
+#define __HISTORY_TEST_H__
+
+#include "TestBase.h"
+#include "core/Board.h"
+#include "core/Move.h"
+#include "core/MoveHistory.h"
+#include "core/RandomGenerator.h"
+#include "core/Utils.h"
+#include <cassert>
+#include <iostream>
+
+// Tests which set boards up from long game histories, as the engine does for each move of a real
+// game. The move limit only applies to the moves made after the history, so these boards must
+// still be playable.
+class HistoryTest : public TestBase
+{
+public:
+    std::string TestFileName() const
+    {
+        return "HistoryTests.suite";
+    }
+
+    // Parse the lines describing the test and execute it.
+    bool Run(const std::vector<std::string>& lines)
+    {
+        // There should be one line containing the board size, the seed and the history length.
+        assert(lines.size() == 1);
+        Utils utils;
+        auto split = utils.Split(lines[0], ' ');
+        assert(split.size() == 3);
+
+        int boardSize = stoi(split[0]);
+        int seed = stoi(split[1]);
+        int length = stoi(split[2]);
+
+        return RunTest(boardSize, seed, length);
+    }
+
+private:
+    bool RunTest(int boardSize, int seed, int length) const
+    {
+        // The history must be longer than any game which is played out on the board.
+        bool pass = length > MaxMovesPerPoint*boardSize*boardSize;
+
+        RandomGenerator gen(seed);
+        MoveHistory history;
+        Colour colourToMove = Black;
+        while (pass && (int)history.Size() < length)
+        {
+            // Set the board up from the history so far, as the engine would, and check that the
+            // game can continue.
+            Board<> board(colourToMove, boardSize, history);
+            pass = !board.GameOver();
+            if (pass)
+            {
+                Move move = RandomMove(board, gen);
+                history.AddMove(move);
+                colourToMove = move.Col() == Black ? White : Black;
+            }
+        }
+
+        if (!pass)
+        {
+            std::cout << "Game over after " << history.Size() << " moves" << std::endl;
+            return false;
+        }
+
+        // Histories longer than the board has room for are cut short rather than overflowing it.
+        Board<> board(colourToMove, boardSize, history);
+        if (length > MaxGameLength)
+        {
+            MoveHistory truncated;
+            auto moves = history.Moves();
+            for (int i = 0; i < MaxGameLength; i++)
+                truncated.AddMove(moves[i]);
+
+            Board<> expected(colourToMove, boardSize, truncated);
+            if (board.CurrentHash() != expected.CurrentHash())
+            {
+                std::cout << "Over-long history was not truncated" << std::endl;
+                return false;
+            }
+        }
+
+        // The board set up from the full history should be able to play a whole game's worth of
+        // moves on top of it.
+        std::cout << board.ToString() << std::endl;
+        int moves = 0;
+        while (!board.GameOver())
+        {
+            board.MakeMove(RandomMove(board, gen));
+            ++moves;
+        }
+
+        std::cout << "Moves after the history: " << moves << std::endl;
+        return moves > 0;
+    }
+
+    // Choose a random legal move, including ones which fill eyes so that stones keep being
+    // captured and the game can go on for as long as needed.
+    Move RandomMove(const Board<>& board, RandomGenerator& gen) const
+    {
+        std::vector<Move> moves;
+        int area = board.Size()*board.Size();
+        for (int i = 0; i < area; i++)
+        {
+            MoveInfo info = board.CheckMove(i);
+            if (info & Legal)
+                moves.push_back({ board.ColourToMove(), i, info });
+        }
+
+        if (moves.empty())
+            return { board.ColourToMove(), PassCoord, Legal };
+
+        return moves[gen.Next(moves.size())];
+    }
+};
+
+#endif // __HISTORY_TEST_H__
@@ -19,52 +19,81 @@ public:
     bool Run(const std::vector<std::string>& lines)
     {
         std::vector<Move> moves;
-        std::string koCoord;
+        std::vector<std::string> koCoords;
+        std::vector<std::string> legalCoords;
+        bool playout = false;
+        std::vector<std::string>* reading = nullptr;
         bool readingMoves = false;
-        bool readingKo = false;
         for (const std::string& line : lines)
         {
-            if (StartsWith(line, "Moves"))
+            if (StartsWith(line, "Playout"))
+            {
+                playout = true;
+            }
+            else if (StartsWith(line, "Moves"))
             {
                 readingMoves = true;
-                readingKo = false;
+                reading = nullptr;
             }
             else if (StartsWith(line, "Ko"))
             {
                 readingMoves = false;
-                readingKo = true;
+                reading = &koCoords;
+            }
+            else if (StartsWith(line, "Legal"))
+            {
+                readingMoves = false;
+                reading = &legalCoords;
             }
             else if (readingMoves)
             {
                 moves.push_back(StringToMove(line, N));
             }
-            else if (readingKo)
+            else if (reading != nullptr)
             {
-                koCoord = line;
+                reading->push_back(line);
             }
         }
 
-        return RunTest(moves, koCoord);
+        return RunTest(moves, koCoords, legalCoords, playout);
     }
 
 private:
     // All test cases are 9x9.
     const int N = 9;
 
-    bool RunTest(const std::vector<Move>& moves, const std::string& koCoord) const
+    bool RunTest(const std::vector<Move>& moves,
+                 const std::vector<std::string>& koCoords,
+                 const std::vector<std::string>& legalCoords,
+                 bool playout) const
     {
-        Board board(N);
-        return CheckMoves(board, moves) && CheckKo(board, koCoord);
+        // In playout mode only simple ko is checked, so the whole game is played in that mode.
+        Board<> board(N);
+        if (playout)
+            board.EnterPlayoutMode();
+
+        if (!CheckMoves(board, moves))
+            return false;
+
+        std::cout << board.ToString() << std::endl;
+        bool pass = true;
+        for (const std::string& koCoord : koCoords)
+            pass = pass && CheckKo(board, koCoord);
+
+        for (const std::string& legalCoord : legalCoords)
+            pass = pass && CheckLegal(board, legalCoord);
+
+        return pass;
     }
 
     // Check that the sequence of moves is legal.
-    bool CheckMoves(Board& board, const std::vector<Move>& moves) const
+    bool CheckMoves(Board<>& board, const std::vector<Move>& moves) const
     {
         bool pass = true;
         for (Move move : moves)
         {
             std::cout << MoveToString(move, N) << std::endl;
-            if (board.CheckMove(move.Col, move.Coord) & Legal)
+            if (board.CheckMove(move.Col(), move.Coord) & Legal)
             {
                 board.MakeMove(move);
             }
@@ -80,13 +109,19 @@ private:
     }
 
     // Check whether the specified ko coordinate is correctly recognised.
-    bool CheckKo(const Board& board, const std::string& koCoord) const
+    bool CheckKo(const Board<>& board, const std::string& koCoord) const
     {
-        std::cout << board.ToString() << std::endl;
         int coord = StringToCoord(koCoord, N);
         return board.CheckMove(coord) & Repetition;
     }
 
+    // Check that the ko rule doesn't stop the next player from playing at the coordinate.
+    bool CheckLegal(const Board<>& board, const std::string& legalCoord) const
+    {
+        int coord = StringToCoord(legalCoord, N);
+        return board.CheckMove(coord) & Legal;
+    }
+
     bool StartsWith(const std::string& str, const std::string& sub) const
     {
         return str.compare(0, sub.size(), sub) == 0;
@@ -53,18 +53,18 @@ private:
 
     bool RunTest(const std::vector<Move>& moves, const std::vector<std::string>& finalBoard) const
     {
-        Board board(N);
+        Board<> board(N);
         return CheckMoves(board, moves) && CheckBoard(board, finalBoard);
     }
 
     // Check that the sequence of moves is legal.
-    bool CheckMoves(Board& board, const std::vector<Move>& moves) const
+    bool CheckMoves(Board<>& board, const std::vector<Move>& moves) const
     {
         bool pass = true;
         for (Move move : moves)
         {
             std::cout << MoveToString(move, N) << std::endl;
-            if (board.CheckMove(move.Col, move.Coord) & Legal)
+            if (board.CheckMove(move.Col(), move.Coord) & Legal)
             {
                 board.MakeMove(move);
             }
@@ -80,7 +80,7 @@ private:
     }
 
     // Check that the final board state is correct.
-    bool CheckBoard(const Board& board, const std::vector<std::string>& finalBoard) const
+    bool CheckBoard(const Board<>& board, const std::vector<std::string>& finalBoard) const
     {
         bool pass = true;
         for (int r = N-1; r >= 0 && pass; r--)
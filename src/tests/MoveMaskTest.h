@@ -0,0 +1,92 @@
+#ifndef __MOVE_MASK_TEST_H__
+#define __MOVE_MASK_TEST_H__
+
+#include "TestBase.h"
+#include "core/Board.h"
+#include "core/Move.h"
+#include "core/RandomGenerator.h"
+#include "core/Utils.h"
+#include <cassert>
+#include <iostream>
+
+// Tests which check that the bulk move masks agree with checking each move in turn.
+class MoveMaskTest : public TestBase
+{
+public:
+    std::string TestFileName() const
+    {
+        return "MoveMaskTests.suite";
+    }
+
+    // Parse the lines describing the test and execute it.
+    bool Run(const std::vector<std::string>& lines)
+    {
+        // There should be one line containing the board size and the seed.
+        assert(lines.size() == 1);
+        Utils utils;
+        auto split = utils.Split(lines[0], ' ');
+        assert(split.size() == 2);
+
+        int boardSize = stoi(split[0]);
+        int seed = stoi(split[1]);
+
+        return RunTest(boardSize, seed);
+    }
+
+private:
+    bool RunTest(int boardSize, int seed) const
+    {
+        return DispatchBoardSize(boardSize, [&]<int N>()
+        {
+            // Play a random game, checking the masks for both colours in every position.
+            RandomGenerator gen(seed);
+            Board<N> board(boardSize);
+            bool pass = CheckMasks(board, Black) && CheckMasks(board, White);
+            while (pass && !board.GameOver())
+            {
+                auto moves = board.GetRandomLegalMoves(1, gen);
+                board.MakeMove(moves[gen.Next(moves.size())]);
+                pass = CheckMasks(board, Black) && CheckMasks(board, White);
+            }
+
+            return pass;
+        });
+    }
+
+    template<int N>
+    bool CheckMasks(const Board<N>& board, Colour col) const
+    {
+        auto masks = board.GetMoveMasks(col);
+        const BitSet<N>* sets[] = { &masks.Legal, &masks.Suicide, &masks.Repetition,
+                                    &masks.Capture, &masks.Atari, &masks.FillsEye };
+        const MoveInfo flags[] = { Legal, Suicide, Repetition, Capture, Atari, FillsEye };
+
+        bool pass = true;
+        int area = board.Size()*board.Size();
+        for (int i = 0; i < 6; i++)
+        {
+            // The masks should only contain points on the board.
+            size_t expected = 0;
+            for (int coord = 0; coord < area; coord++)
+            {
+                MoveInfo info = board.CheckMove(col, coord);
+                bool flagged = info & flags[i];
+                expected += flagged ? 1 : 0;
+                if (flagged != sets[i]->Test(board.ToPoint(coord)))
+                {
+                    std::cout << "Mask " << i << " mismatch for colour " << col
+                              << " at " << coord << std::endl;
+                    pass = false;
+                }
+            }
+
+            pass = pass && sets[i]->Count() == expected;
+        }
+
+        if (!pass) std::cout << board.ToString() << std::endl;
+
+        return pass;
+    }
+};
+
+#endif // __MOVE_MASK_TEST_H__
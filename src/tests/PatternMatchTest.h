@@ -59,7 +59,7 @@ private:
 
     bool RunTest(const std::vector<Move>& moves, Colour colourToMove, bool isMatch) const
     {
-        Board board(N);
+        Board<> board(N);
         for (Move move : moves)
         {
             board.MakeMove(move);
@@ -73,7 +73,7 @@ private:
     }
 
     // Check whether there is a matching pattern for this 3x3 position.
-    bool CheckForPattern(const Board& board, Colour colourToMove) const
+    bool CheckForPattern(const Board<>& board, Colour colourToMove) const
     {
         int boardCentreLoc = N*N/2;
         PatternMatcher matcher;
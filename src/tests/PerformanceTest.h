@@ -36,21 +36,34 @@ public:
 private:
     bool RunTest(int boardSize, int duration) const
     {
-        Board board(boardSize);
+        DispatchBoardSize(boardSize, [&]<int N>()
+        {
+            Board<N> board(boardSize);
 
-        // Spawn a searching thread for this position.
-        CurrentSearch search;
-        search.Start(board);
+            // Spawn a searching thread for this position.
+            CurrentSearch<N> search;
+            search.Start(board);
 
-        // Allow the search to continue for the specified duration.
-        std::chrono::seconds searchTime(duration);
-        std::this_thread::sleep_for(searchTime);
-        search.Stop();
+            // Allow the search to continue for the specified duration.
+            std::chrono::seconds searchTime(duration);
+            std::this_thread::sleep_for(searchTime);
+            search.Stop();
 
-        const MoveStats& best = search.Best();
-        const Move& move = best.LastMove;
-        std::cout << MoveToString(move, boardSize) << std::endl;
-        std::cout << "Tree size: " << search.TreeSize() << std::endl;
+            const MoveStats& best = search.Best();
+            const Move& move = best.LastMove;
+            std::cout << MoveToString(move, boardSize) << std::endl;
+            std::cout << "Tree size: " << search.TreeSize() << std::endl;
+            std::cout << "Tree memory (KB): " << search.TreeMemory() / 1024 << std::endl;
+
+            // Starting the next search releases the tree, which should be quick however large the
+            // tree has grown.
+            typedef std::chrono::steady_clock Clock;
+            auto start = Clock::now();
+            search.Start(board);
+            std::chrono::duration<double, std::milli> restart = Clock::now() - start;
+            search.Stop();
+            std::cout << "Restart time (ms): " << restart.count() << std::endl;
+        });
 
         return true;
     }
@@ -0,0 +1,86 @@
+#ifndef __SCORE_TEST_H__
+#define __SCORE_TEST_H__
+
+#include "TestBase.h"
+#include "core/Board.h"
+#include "core/Rules.h"
+#include <iostream>
+
+class ScoreTest : public TestBase
+{
+public:
+    std::string TestFileName() const
+    {
+        return "ScoreTests.suite";
+    }
+
+    // Parse the lines describing the test and execute it.
+    bool Run(const std::vector<std::string>& lines)
+    {
+        std::vector<std::string> board;
+        double komi = 0;
+        double margin = 0;
+        auto state = State::None;
+        for (const std::string& line : lines)
+        {
+            if (StartsWith(line, "Position"))
+            {
+                state = State::Position;
+            }
+            else if (StartsWith(line, "Komi"))
+            {
+                state = State::Komi;
+            }
+            else if (StartsWith(line, "Margin"))
+            {
+                state = State::Margin;
+            }
+            else if (state == State::Position)
+            {
+                board.push_back(line);
+            }
+            else if (state == State::Komi)
+            {
+                komi = stod(line);
+            }
+            else if (state == State::Margin)
+            {
+                margin = stod(line);
+            }
+        }
+
+        return RunTest(board, komi, margin);
+    }
+
+private:
+    enum class State
+    {
+        None,
+        Position,
+        Komi,
+        Margin
+    };
+
+    bool RunTest(const std::vector<std::string>& lines, double komi, double margin) const
+    {
+        Board<> board(Black, lines);
+        std::cout << board.ToString() << std::endl;
+
+        double previousKomi = CurrentRules.Komi;
+        CurrentRules.Komi = komi;
+        double result = board.ScoreMargin();
+        CurrentRules.Komi = previousKomi;
+
+        std::cout << "Expected: " << margin << std::endl;
+        std::cout << "Got: " << result << std::endl;
+
+        return result == margin;
+    }
+
+    bool StartsWith(const std::string& str, const std::string& sub) const
+    {
+        return str.compare(0, sub.size(), sub) == 0;
+    }
+};
+
+#endif // __SCORE_TEST_H__
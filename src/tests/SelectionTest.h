@@ -0,0 +1,104 @@
+#ifndef __SELECTION_TEST_H__
+#define __SELECTION_TEST_H__
+
+#include "TestBase.h"
+#include "core/Move.h"
+#include "core/MoveBuffer.h"
+#include "core/Utils.h"
+#include "search/Node.h"
+#include "search/Selection/UCBPriors.h"
+#include "search/Selection/MCRavePriors.h"
+#include <cassert>
+#include <iostream>
+
+// Tests which check the child that each selection policy chooses given the children's statistics.
+class SelectionTest : public TestBase
+{
+public:
+    std::string TestFileName() const
+    {
+        return "SelectionTests.suite";
+    }
+
+    // Parse the lines describing the test and execute it.
+    bool Run(const std::vector<std::string>& lines)
+    {
+        // The first line contains the policy and the index of the child it should choose.
+        // Each of the other lines contains a child's visits, wins, RAVE visits, RAVE wins and
+        // optionally "Capture" if its move is a capture.
+        assert(lines.size() > 1);
+        Utils utils;
+        auto split = utils.Split(lines[0], ' ');
+        assert(split.size() == 2);
+
+        std::string policy = split[0];
+        int solution = stoi(split[1]);
+
+        std::vector<std::vector<std::string>> children;
+        for (size_t i = 1; i < lines.size(); i++)
+            children.push_back(utils.Split(lines[i], ' '));
+
+        return RunTest(policy, children, solution);
+    }
+
+private:
+    bool RunTest(const std::string& policy,
+                 const std::vector<std::vector<std::string>>& childLines,
+                 int solution) const
+    {
+        // Make a root with a child for each line.
+        MoveBuffer moves;
+        for (size_t i = 0; i < childLines.size(); i++)
+        {
+            bool capture = childLines[i].size() > 4 && childLines[i][4] == "Capture";
+            moves.push_back({ Black, (int)i, Legal | (capture ? Capture : 0) });
+        }
+
+        NodeArena arena;
+        Node* root = MakeRoot(arena);
+        root->StartExpansion();
+        root->AddChildren(moves, arena);
+
+        ChildStats& children = *root->Children;
+        int totalVisits = 0;
+        for (int i = 0; i < children.Count; i++)
+        {
+            assert(childLines[i].size() >= 4);
+            children.Visits[i] = stoi(childLines[i][0]);
+            children.Wins[i] = stoi(childLines[i][1]);
+            children.RaveVisits[i] = stoi(childLines[i][2]);
+            children.RaveWins[i] = stoi(childLines[i][3]);
+            totalVisits += children.Visits[i];
+        }
+
+        root->Siblings->Visits[root->Index] = totalVisits;
+
+        Node* selected = nullptr;
+        if (policy == "UCB1")
+        {
+            selected = UCB1().Select(children);
+        }
+        else if (policy == "UCBPriors")
+        {
+            selected = UCBPriors().Select(children);
+        }
+        else if (policy == "MCRave")
+        {
+            selected = MCRave().Select(children);
+        }
+        else if (policy == "MCRavePriors")
+        {
+            selected = MCRavePriors().Select(children);
+        }
+        else
+        {
+            std::cout << "Unknown policy: " << policy << std::endl;
+            return false;
+        }
+
+        std::cout << "Selected: " << selected->Index << std::endl;
+        return selected->Index == solution;
+    }
+};
+
+#endif // __SELECTION_TEST_H__
@@ -50,20 +50,20 @@ public:
 
 private:
     // All test cases are 9x9.
-    const int N = 9;
+    static const int N = 9;
 
     // Attempt to solve the tsumego.
     // It is always black to move.
     bool RunTest(const std::vector<std::string>& lines, const Move& solution) const
     {
-        Board board(Black, lines);
+        Board<N> board(Black, lines);
         std::cout << board.ToString() << std::endl;
         CurrentRules.Komi = N*N - 1; // Black must kill everything to win.
 
         // Spawn a searching thread for this position.
         // Note: The UCB1 algorithm is used for this as it seems to perform better in these
         // restricted scenarios.
-        CurrentSearch search;
+        CurrentSearch<N> search;
         search.Start(board);
 
         // Allow the search to continue for 5 seconds.
@@ -76,7 +76,7 @@ private:
         std::cout << MoveToString(move, N) << std::endl;
         std::cout << "Win rate: " << best.WinningChance() << std::endl;
 
-        return move.Col == solution.Col && move.Coord == solution.Coord;
+        return move.Col() == solution.Col() && move.Coord == solution.Coord;
     }
 
     bool StartsWith(const std::string& str, const std::string& sub) const
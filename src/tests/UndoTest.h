@@ -0,0 +1,165 @@
+#ifndef __UNDO_TEST_H__
+#define __UNDO_TEST_H__
+
+#include "TestBase.h"
+#include "core/Board.h"
+#include "core/Move.h"
+#include "core/RandomGenerator.h"
+#include "core/Utils.h"
+#include <cassert>
+#include <iostream>
+
+// Tests which check that undoing moves restores the previous board state exactly.
+// The specialised boards are also checked against the general board as the moves are made.
+class UndoTest : public TestBase
+{
+public:
+    std::string TestFileName() const
+    {
+        return "UndoTests.suite";
+    }
+
+    // Parse the lines describing the test and execute it.
+    bool Run(const std::vector<std::string>& lines)
+    {
+        // There should be one line containing the board size, the seed and the mode.
+        assert(lines.size() == 1);
+        Utils utils;
+        auto split = utils.Split(lines[0], ' ');
+        assert(split.size() == 3);
+
+        int boardSize = stoi(split[0]);
+        int seed = stoi(split[1]);
+        bool playoutMode = split[2] == "Playout";
+
+        return RunTest(boardSize, seed, playoutMode);
+    }
+
+private:
+    bool RunTest(int boardSize, int seed, bool playoutMode) const
+    {
+        return DispatchBoardSize(boardSize, [&]<int N>()
+        {
+            RandomGenerator gen(seed);
+            Board<N> board(boardSize);
+            Board<> reference(boardSize);
+            if (playoutMode)
+            {
+                board.EnterPlayoutMode();
+                reference.EnterPlayoutMode();
+            }
+
+            UndoJournal<N> journal;
+            UndoJournal<> referenceJournal;
+            std::vector<std::string> states;
+
+            // Play a game to the end, undo half of it and then play a different ending before
+            // undoing everything.
+            bool pass = PlayToEnd(board, journal, reference, referenceJournal, states, gen);
+            size_t half = states.size()/2;
+            pass = pass && UndoMoves(board, journal, reference, referenceJournal, states, half);
+
+            pass = pass && PlayToEnd(board, journal, reference, referenceJournal, states, gen);
+            pass = pass && UndoMoves(board, journal, reference, referenceJournal, states, 0);
+
+            return pass && journal.Empty() && board.ToString() == Board<N>(boardSize).ToString();
+        });
+    }
+
+    // Play random moves until the game is over, recording the state before each one.
+    template<int N>
+    bool PlayToEnd(Board<N>& board,
+                   UndoJournal<N>& journal,
+                   Board<>& reference,
+                   UndoJournal<>& referenceJournal,
+                   std::vector<std::string>& states,
+                   RandomGenerator& gen) const
+    {
+        bool pass = true;
+        while (pass && !board.GameOver())
+        {
+            auto moves = board.GetRandomLegalMoves(1, gen);
+            Move move = moves[gen.Next(moves.size())];
+            states.push_back(State(board));
+            board.MakeMove(move, journal);
+            reference.MakeMove(move, referenceJournal);
+            pass = CheckReference(board, reference);
+        }
+
+        return pass;
+    }
+
+    // Undo moves until only the specified number remain, checking the state after each one.
+    template<int N>
+    bool UndoMoves(Board<N>& board,
+                   UndoJournal<N>& journal,
+                   Board<>& reference,
+                   UndoJournal<>& referenceJournal,
+                   std::vector<std::string>& states,
+                   size_t remaining) const
+    {
+        bool pass = true;
+        while (pass && states.size() > remaining)
+        {
+            board.UnmakeMove(journal);
+            reference.UnmakeMove(referenceJournal);
+            pass = State(board) == states.back();
+            if (!pass)
+            {
+                std::cout << "Mismatch after undoing move " << states.size() << std::endl;
+                std::cout << board.ToString() << std::endl;
+            }
+
+            pass = pass && CheckReference(board, reference);
+            states.pop_back();
+        }
+
+        return pass;
+    }
+
+    // Check that the board is in the same state as the general board.
+    template<int N>
+    bool CheckReference(const Board<N>& board, const Board<>& reference) const
+    {
+        bool pass = State(board) == State(reference);
+        if (!pass)
+        {
+            std::cout << "Mismatch with the general board" << std::endl;
+            std::cout << board.ToString() << std::endl;
+        }
+
+        return pass;
+    }
+
+    // Summarise the observable state of the board.
+    // The properties of every move depend on the chains' liberties and the position history.
+    // Positions aren't hashed in playout mode, where the ko point is checked via the moves instead.
+    template<int N>
+    std::string State(const Board<N>& board) const
+    {
+        std::string s = board.ToString();
+        if (!board.InPlayoutMode())
+            s += std::to_string(board.CurrentHash()) + " ";
+
+        s += std::to_string(board.ColourToMove()) + " ";
+        s += std::to_string(board.GameOver()) + " ";
+        s += std::to_string(board.ScoreMargin()) + "\n";
+
+        // Random sampling depends on the order of the empty points, which should also be restored.
+        RandomGenerator gen(1070372);
+        for (int i = 0; i < 8 && board.NumEmpty() > 0; i++)
+        {
+            s += std::to_string(board.GetRandomEmptyCoord(gen)) + " ";
+        }
+
+        int area = board.Size()*board.Size();
+        for (int i = 0; i < area; i++)
+        {
+            s += std::to_string(board.CheckMove(i)) + " ";
+        }
+
+        return s;
+    }
+};
+
+#endif // __UNDO_TEST_H__
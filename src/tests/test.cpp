@@ -3,9 +3,15 @@
 #include "TestRunner.h"
 #include "MakeMoveTest.h"
 #include "KoDetectionTest.h"
+#include "BenchmarkTest.h"
 #include "PerformanceTest.h"
 #include "PatternMatchTest.h"
+#include "ScoreTest.h"
 #include "TsumegoTest.h"
+#include "UndoTest.h"
+#include "HistoryTest.h"
+#include "SelectionTest.h"
+#include "MoveMaskTest.h"
 #include "ExperimentTest.h"
 #include "lurien.h"
 #include <iostream>
@@ -29,6 +35,7 @@ int main(int argc, char* argv[])
     {
         // Execute the performance tests.
         TestRunner runner;
+        runner.RunTests<BenchmarkTest>();
         runner.RunTests<PerformanceTest>();
     }
     else
@@ -38,6 +45,11 @@ int main(int argc, char* argv[])
         runner.RunTests<MakeMoveTest>();
         runner.RunTests<KoDetectionTest>();
         runner.RunTests<PatternMatchTest>();
+        runner.RunTests<ScoreTest>();
+        runner.RunTests<UndoTest>();
+        runner.RunTests<HistoryTest>();
+        runner.RunTests<MoveMaskTest>();
+        runner.RunTests<SelectionTest>();
         runner.RunTests<TsumegoTest>();
     }
 